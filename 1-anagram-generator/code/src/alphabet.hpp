@@ -0,0 +1,117 @@
+#ifndef ALPHABET_HH
+#define ALPHABET_HH
+
+#include <array>
+#include <string>
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * An alphabet descriptor gives, at compile time, the number of letters of the
+ * alphabet ('size') and the mapping of a byte to the index of its letter
+ * ('index', which returns -1 if the byte is not a letter of the alphabet).
+ *
+ * All the data structures of the anagram core (histogram, mask) are
+ * templates on such a descriptor, so that each alphabet gets its own
+ * specialised code, without any runtime dispatch.
+ */
+
+/// English alphabet : [a, z]
+struct English {
+	static constexpr unsigned size = 26;
+
+	static constexpr int index(unsigned char c) {
+		return (c >= 'a' && c <= 'z') ? c - 'a' : -1;
+	}
+};
+
+/// Accented Latin alphabet (ISO-8859-1) : [a, z] and [0xdf, 0xff] except 0xf7
+struct Latin1 {
+	static constexpr unsigned size = 58;
+
+	static constexpr int index(unsigned char c) {
+		return (c >= 'a' && c <= 'z') ? c - 'a' :
+			(c >= 0xdf && c != 0xf7) ? 26 + (c - 0xdf) - (c > 0xf7) : -1;
+	}
+};
+
+/// Russian alphabet (ISO-8859-5) : [0xd0, 0xef] and 0xf1
+struct Cyrillic {
+	static constexpr unsigned size = 33;
+
+	static constexpr int index(unsigned char c) {
+		return (c >= 0xd0 && c <= 0xef) ? c - 0xd0 : (c == 0xf1) ? 32 : -1;
+	}
+};
+
+/// The histogram of a word contains the number of occurrences of each letter.
+/// Its width is rounded up to a multiple of 32 bytes (so that operations on
+/// histograms are done with full vector registers).
+template<typename A>
+using Histogram = std::array<uint8_t, (A::size + 31) / 32 * 32>;
+
+/// The mask of a word has its i-th bit set if the word contains the i-th
+/// letter of the alphabet.
+template<typename A>
+using Mask = typename std::conditional<(A::size <= 32), uint32_t, uint64_t>::type;
+
+/**
+ * This function computes the histogram and the mask of a string.
+ *
+ * @param 	str The string
+ * @param 	hist The histogram of the string
+ * @param 	mask The mask of the string
+ * @return 	A Boolean value indicating whether the string contains only
+ *			letters of the alphabet (with at most 255 occurrences each)
+ */
+template<typename A>
+inline bool make_histogram(const std::string& str, Histogram<A>& hist, Mask<A>& mask) {
+	hist.fill(0);
+	mask = 0;
+
+	for(char c : str) {
+		int i = A::index(static_cast<unsigned char>(c));
+
+		if(i < 0 || hist[unsigned(i)] == UINT8_MAX)
+			return false;
+
+		hist[unsigned(i)]++;
+		mask |= Mask<A>(1) << i;
+	}
+
+	return true;
+}
+
+/**
+ * This function checks whether all the letters of a histogram are also in
+ * another one.
+ *
+ * @param 	hist The histogram
+ * @param 	sub The histogram to check
+ * @return 	A Boolean value indicating whether 'sub' is included in 'hist'
+ */
+template<typename A>
+inline bool includes(const Histogram<A>& hist, const Histogram<A>& sub) {
+	uint8_t missing = 0;
+
+	for(unsigned i = 0; i < hist.size(); i++)
+		missing |= uint8_t(hist[i] < sub[i]);
+
+	return !missing;
+}
+
+/**
+ * This function removes the letters of a histogram from another one. The
+ * first histogram must include the second one.
+ *
+ * @param 	hist The histogram to which letters are removed
+ * @param 	sub The histogram of the letters to remove
+ * @param 	d The difference between 'hist' and 'sub'
+ */
+template<typename A>
+inline void subtract(const Histogram<A>& hist, const Histogram<A>& sub, Histogram<A>& d) {
+	for(unsigned i = 0; i < hist.size(); i++)
+		d[i] = uint8_t(hist[i] - sub[i]);
+}
+
+#endif
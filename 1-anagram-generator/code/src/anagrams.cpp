@@ -13,6 +13,11 @@
 #include <fstream>
 #include <algorithm>
 #include <cstdlib>
+#include <cstring>
+#include <climits>
+#include <cmath>
+#include <chrono>
+#include <random>
 
 #include "anagrams.hpp"
 
@@ -23,108 +28,222 @@ using namespace std;
 	exit(EXIT_FAILURE);
 }
 
-static string get_sorted(const string& str) {
-	string sorted = str;
-	sort(sorted.begin(), sorted.end());
+/// Value of an empty slot of an index (and of the end of a group of words)
+static const unsigned NONE = UINT_MAX;
 
-	return sorted;
+/**
+ * This function computes the hash of a histogram.
+ *
+ * @param 	hist The histogram
+ * @return 	The hash of the histogram
+ */
+template<typename A>
+static uint64_t hash_histogram(const Histogram<A>& hist) {
+	uint64_t h = 0, w;
+
+	for(unsigned i = 0; i < hist.size(); i += sizeof(w)) {
+		memcpy(&w, hist.data() + i, sizeof(w));
+		h = (h ^ w) * 0x9e3779b97f4a7c15;
+	}
+
+	return h ^ (h >> 32);
 }
 
 /**
- * This function removes all spaces from a string and checks whether it is
- * composed exclusively of characters included in [a, z].
+ * This function returns the slot of an index corresponding to a histogram,
+ * i.e. the slot of the group of words having this histogram if it exists,
+ * or the empty slot where this group should be inserted otherwise.
  *
- * @param 	str The string to check
- * @return 	A Boolean value indicating whether the string contains only
- * 			characters included in [a, z]
+ * @param 	hist The histogram
+ * @param 	dict The dictionary of words
+ * @param 	index The index of the dictionary
+ * @return 	The position of the slot in the index
  */
-static bool check_word(string& str) {
-	if(str.empty())
-		return false;
+template<typename A>
+static size_t find_slot(const Histogram<A>& hist, const BasicDictionary<A>& dict, const Index& index) {
+	size_t m = index.slots.size() - 1;
+	size_t s = size_t(hash_histogram<A>(hist)) & m;
 
-	str.erase(remove_if(str.begin(), str.end(), ::isspace), str.end());
-
-	for(char c : str)
-		if(!(isalpha(c) && islower(c)))
-			return false;
+	while(index.slots[s] != NONE && dict[index.slots[s]].histogram != hist)
+		s = (s + 1) & m;
 
-	return true;
+	return s;
 }
 
 /**
- * This function takes as input two strings and checks if it is possible to
- * remove at the first all the letters of the seconds. If this is the case,
- * the difference of the strings is stored in a parameter passed as reference.
+ * This function computes the score of a word, i.e. the quantity of
+ * information of its letters.
  *
- * @param 	str The string to which we will remove letters, if possible
- * @param 	sub The string to remove at the first string
- * @param 	d 	The string that will contains the difference between str and
- 				sub, if this difference is possible
- * @return 	A Boolean value indicating whether it is possible to remove
- *			letters from the second string to the first
+ * @param 	hist The histogram of the word
+ * @param 	index The index of the dictionary
+ * @return 	The score of the word
  */
-static bool diff(const string& str, const string& sub, string& d) {
-	if(str.size() < sub.size())
-		return false;
+template<typename A>
+static float score(const Histogram<A>& hist, const Index& index) {
+	double s = 0;
 
-	d = str;
+	for(unsigned l = 0; l < A::size && l < index.information.size(); l++)
+		s += hist[l] * index.information[l];
 
-	auto it1 = sub.begin();
-	auto it2 = d.begin();
+	return float(s);
+}
 
-	while(it1 != sub.end())
-		if(it2 == d.end() || *it1 < *it2)
-			return false;
-		else if(*it1 > *it2)
-			it2++;
-		else {
-			it2 = d.erase(it2);
-			it1++;
-		}
+/**
+ * This function removes all spaces from a string and checks whether it is
+ * composed exclusively of letters of the alphabet 'A' (for the English
+ * alphabet, characters included in [a, z]). If this is the case, it also
+ * computes the histogram and the mask of the string.
+ *
+ * @param 	str The string to check
+ * @param 	hist The histogram of the string
+ * @param 	mask The mask of the string
+ * @return 	A Boolean value indicating whether the string contains only
+ * 			letters of the alphabet
+ */
+template<typename A>
+static bool check_word(string& str, Histogram<A>& hist, Mask<A>& mask) {
+	if(str.empty())
+		return false;
 
-	return true;
+	str.erase(remove_if(str.begin(), str.end(), [](unsigned char c) { return isspace(c); }), str.end());
+
+	return make_histogram<A>(str, hist, mask);
 }
 
 /**
  * This function recursively finds the anagrams of a string based on
  * available dictionary words.
  *
- * @param 	letters The remaining letters to form an anagram
+ * @param 	letters The histogram of the remaining letters to form an anagram
+ * @param 	length The number of remaining letters
  * @param 	dict The dictionary words available to form an anagram
  * @param 	search 	The position of elements that can be part of an anagram in
- *					the dictionary
- * @param 	chosen The vector of words forming a solution
- * @param 	results The vector containing all the possible anagrams
+ *					the dictionary (in decreasing order)
+ * @param 	chosen The positions of the words forming a solution
+ * @param 	found The function called with each anagram found
  * @param 	max The maximum number of words (-1 for no restriction)
  */
-static void find(const string& letters, const Dictionary& dict, const vector<long>& search, vector<string>& chosen, vector<vector<string>>& results, const int max) {
-	string d;
+template<typename A, typename F>
+static void find(const Histogram<A>& letters, size_t length, const BasicDictionary<A>& dict, const vector<long>& search, Positions& chosen, F& found, const int max) {
+	Histogram<A> d;
 	vector<long> update;
 
 	/// If the word limit is reached
 	if(max == 0)
 		return;
 
-	for(auto i = search.rbegin(); i != search.rend(); i++)
-		if(diff(letters, dict[unsigned(*i)].second, d)) {
-			update.insert(update.begin(), *i);
+	for(long i : search) {
+		const Entry<A>& e = dict[unsigned(i)];
+
+		if(e.word.size() <= length && includes<A>(letters, e.histogram)) {
+			update.push_back(i);
 
 			/// We add the word to a possible solution
-			chosen.push_back(dict[unsigned(*i)].first);
+			chosen.push_back(uint32_t(i));
 
-			if(!d.empty())
-				find(d, dict, update, chosen, results, max - 1);
-			else
-				results.push_back(chosen);
+			if(e.word.size() < length) {
+				subtract<A>(letters, e.histogram, d);
+				find(d, length - e.word.size(), dict, update, chosen, found, max - 1);
+			} else {
+				found(chosen);
+			}
 
 			chosen.pop_back();
 		}
+	}
+}
+
+/**
+ * This function does the same as 'find', but the words are explored in the
+ * order of 'search' (from its beginning), each word being only followed by
+ * the words after it in this order.
+ *
+ * @param 	letters The histogram of the remaining letters to form an anagram
+ * @param 	length The number of remaining letters
+ * @param 	dict The dictionary words available to form an anagram
+ * @param 	begin The first element of the search list
+ * @param 	end The end of the search list
+ * @param 	chosen The positions of the words forming a solution
+ * @param 	found The function called with each anagram found
+ * @param 	max The maximum number of words (-1 for no restriction)
+ */
+template<typename A, typename F>
+static void find_ranked(const Histogram<A>& letters, size_t length, const BasicDictionary<A>& dict, const long* begin, const long* end, Positions& chosen, F& found, const int max) {
+	Histogram<A> d;
+	vector<long> update;
+
+	/// If the word limit is reached
+	if(max == 0)
+		return;
+
+	for(const long* i = begin; i != end; i++) {
+		const Entry<A>& e = dict[unsigned(*i)];
+
+		if(e.word.size() <= length && includes<A>(letters, e.histogram))
+			update.push_back(*i);
+	}
+
+	for(size_t k = 0; k < update.size(); k++) {
+		const Entry<A>& e = dict[unsigned(update[k])];
+
+		/// We add the word to a possible solution
+		chosen.push_back(uint32_t(update[k]));
+
+		if(e.word.size() < length) {
+			subtract<A>(letters, e.histogram, d);
+			find_ranked(d, length - e.word.size(), dict, update.data() + k, update.data() + update.size(), chosen, found, max - 1);
+		} else {
+			found(chosen);
+		}
+
+		chosen.pop_back();
+	}
+}
+
+/**
+ * This function converts an anagram found by the search to a vector of words.
+ *
+ * @param 	anagram The anagram
+ * @return 	The words of the anagram
+ */
+static vector<string> to_words(const Anagram& anagram) {
+	vector<string> words;
+
+	for(const string* w : anagram)
+		words.push_back(*w);
+
+	return words;
+}
+
+/**
+ * This function converts the positions of the words of an anagram to the
+ * words of the dictionary.
+ *
+ * @param 	dict The dictionary of words
+ * @param 	positions The positions of the words of the anagram
+ * @param 	anagram The anagram (pointing into the dictionary)
+ */
+template<typename A>
+static void to_anagram(const BasicDictionary<A>& dict, const Positions& positions, Anagram& anagram) {
+	anagram.clear();
+
+	for(uint32_t p : positions)
+		anagram.push_back(&dict[p].word);
 }
 
-Dictionary create_dictionary(const string& filename) {
+/**
+ * This function reads the words of a txt file and adds them to a dictionary.
+ * If an index is given, each valid word is also added to the index.
+ *
+ * @param 	filename The path to the txt file containing the dictionary words
+ * @param	index The index to fill (nullptr to only create the dictionary)
+ * @return 	A dictionary containing all the words in the file in the same order
+ */
+template<typename A>
+static BasicDictionary<A> read_dictionary(const string& filename, Index* index) {
 	ifstream file;
-	string wrd;
-	Dictionary dict;
+	Entry<A> e;
+	BasicDictionary<A> dict;
 	bool warning = false;
 
 	file.open(filename);
@@ -132,9 +251,9 @@ Dictionary create_dictionary(const string& filename) {
 	if(!file)
 		set_error("Unable to open file.");
 
-	while(file >> wrd)
-		if(check_word(wrd))
-			dict.push_back(pair<string, string>(wrd, get_sorted(wrd)));
+	while(file >> e.word)
+		if(check_word<A>(e.word, e.histogram, e.mask))
+			dict.push_back(e);
 		else
 			warning = true;
 
@@ -143,41 +262,548 @@ Dictionary create_dictionary(const string& filename) {
 
 	file.close();
 
+	if(index)
+		*index = create_index(dict);
+
 	return dict;
 }
 
-vector<vector<string>> anagrams(const string& input, const Dictionary& dict, unsigned max) {
-	int limit = int(max);
+template<typename A>
+BasicDictionary<A> create_dictionary(const string& filename) {
+	return read_dictionary<A>(filename, nullptr);
+}
 
-	string correct = input, d;
-	Dictionary filter;
+template<typename A>
+BasicDictionary<A> create_dictionary(const string& filename, Index& index) {
+	return read_dictionary<A>(filename, &index);
+}
 
-	vector<long> search;
-	vector<string> chosen;
-	vector<vector<string>> results;
+template<typename A>
+Index create_index(const BasicDictionary<A>& dict) {
+	Index index;
+	vector<unsigned> last;
+	size_t size = 1, s;
+
+	/// The table is kept at most half full
+	while(size < 2 * dict.size())
+		size *= 2;
+
+	index.slots.assign(size, NONE);
+	index.next.assign(dict.size(), NONE);
+	index.scores.assign(dict.size(), 0);
+	last.assign(dict.size(), NONE);
+
+	for(unsigned i = 0; i < dict.size(); i++) {
+		if(dict[i].removed) {
+			index.nb_removed++;
+
+			continue;
+		}
+
+		s = find_slot(dict[i].histogram, dict, index);
+
+		/// The word is either the first of a new group, or appended to the
+		/// group of the words made of the same letters
+		if(index.slots[s] == NONE)
+			index.slots[s] = i;
+		else
+			index.next[last[index.slots[s]]] = i;
+
+		last[index.slots[s]] = i;
+	}
+
+	/// The quantity of information of a letter is -log2(p), 'p' being its
+	/// frequency among all the letters of the dictionary
+	vector<double> frequencies(A::size, 0);
+	double total = 0;
+
+	index.information.assign(A::size, 0);
+
+	for(const Entry<A>& e : dict)
+		if(!e.removed)
+			for(unsigned l = 0; l < A::size; l++)
+				frequencies[l] += e.histogram[l];
+
+	for(double f : frequencies)
+		total += f;
+
+	for(unsigned l = 0; l < A::size; l++)
+		if(frequencies[l] > 0)
+			index.information[l] = -log2(frequencies[l] / total);
+
+	for(unsigned i = 0; i < dict.size(); i++)
+		index.scores[i] = score<A>(dict[i].histogram, index);
+
+	return index;
+}
+
+/**
+ * This function removes the words marked as removed from a dictionary, and
+ * rebuilds its index (the information of the letters being kept).
+ *
+ * @param	dict The dictionary of words
+ * @param	index The index of the dictionary
+ */
+template<typename A>
+static void rebuild_index(BasicDictionary<A>& dict, Index& index) {
+	vector<double> information = index.information;
+
+	dict.erase(remove_if(dict.begin(), dict.end(), [](const Entry<A>& e) { return e.removed; }), dict.end());
+
+	index = create_index(dict);
+
+	/// The information of the letters is the one of the first index
+	if(!information.empty()) {
+		index.information = information;
+
+		for(unsigned i = 0; i < dict.size(); i++)
+			index.scores[i] = score<A>(dict[i].histogram, index);
+	}
+}
+
+template<typename A>
+bool insert_word(BasicDictionary<A>& dict, Index& index, const string& word) {
+	Entry<A> e;
+	size_t s;
+
+	e.word = word;
+
+	if(!check_word<A>(e.word, e.histogram, e.mask))
+		return false;
+
+	if(index.slots.empty())
+		rebuild_index(dict, index);
+
+	/// The word is already in the dictionary if it is in its group
+	s = find_slot(e.histogram, dict, index);
+
+	for(unsigned i = index.slots[s]; i != NONE; i = index.next[i])
+		if(dict[i].word == e.word)
+			return false;
+
+	unsigned pos = unsigned(dict.size());
+
+	dict.push_back(e);
+
+	/// The table is kept at most half full (otherwise, it is rebuilt)
+	if(2 * dict.size() > index.slots.size()) {
+		rebuild_index(dict, index);
+
+		return true;
+	}
+
+	index.next.push_back(NONE);
+	index.scores.push_back(score<A>(e.histogram, index));
+
+	/// The word is the last one of its group (the groups being in the same
+	/// order as the dictionary)
+	if(index.slots[s] == NONE) {
+		index.slots[s] = pos;
+	} else {
+		unsigned j = index.slots[s];
+
+		while(index.next[j] != NONE)
+			j = index.next[j];
+
+		index.next[j] = pos;
+	}
+
+	return true;
+}
+
+template<typename A>
+bool remove_word(BasicDictionary<A>& dict, Index& index, const string& word) {
+	string w = word;
+	Histogram<A> hist;
+	Mask<A> mask;
+
+	if(!check_word<A>(w, hist, mask))
+		return false;
+
+	if(index.slots.empty())
+		rebuild_index(dict, index);
+
+	size_t s = find_slot(hist, dict, index);
+	unsigned pos = index.slots[s], previous = NONE;
+
+	while(pos != NONE && dict[pos].word != w) {
+		previous = pos;
+		pos = index.next[pos];
+	}
+
+	if(pos == NONE)
+		return false;
+
+	/// The word is unlinked from its group
+	if(previous != NONE) {
+		index.next[previous] = index.next[pos];
+	} else if(index.next[pos] != NONE) {
+		index.slots[s] = index.next[pos];
+	} else {
+		/// The group is empty : the following slots of the same probe
+		/// sequence are moved back, so that they can still be found
+		size_t m = index.slots.size() - 1, i = s, j = s, k;
+
+		while(true) {
+			j = (j + 1) & m;
+
+			if(index.slots[j] == NONE)
+				break;
+
+			k = size_t(hash_histogram<A>(dict[index.slots[j]].histogram)) & m;
+
+			if((i <= j) ? (i < k && k <= j) : (i < k || k <= j))
+				continue;
+
+			index.slots[i] = index.slots[j];
+			i = j;
+		}
+
+		index.slots[i] = NONE;
+	}
+
+	/// The entry is kept (so that the positions of the other words do not
+	/// change) until half of the dictionary is made of removed words
+	dict[pos].removed = true;
+	index.next[pos] = NONE;
+	index.nb_removed++;
+
+	if(2 * index.nb_removed > dict.size())
+		rebuild_index(dict, index);
+
+	return true;
+}
+
+/**
+ * This function checks the input entered by the user and prepares the search
+ * of its anagrams: only the words of the dictionary whose letters are also
+ * in the input are kept.
+ *
+ * @param 	input The string entered by the user
+ * @param	dict The dictionary of words
+ * @param 	letters The histogram of the input
+ * @param 	search 	The position of the words that can be part of an anagram
+ *					in the dictionary (in decreasing order)
+ * @return 	The number of letters of the input
+ */
+template<typename A>
+static size_t prepare(const string& input, const BasicDictionary<A>& dict, Histogram<A>& letters, vector<long>& search) {
+	string correct = input;
+	Mask<A> mask;
 
 	/// We first check the input entered by the user
-	if(!check_word(correct))
+	if(!check_word<A>(correct, letters, mask))
 		set_error("Input is not valid.");
 
-	correct = get_sorted(correct);
-
 	/// A dictionary filter is used: only the words whose letters are also
-	/// in the user's input are kept
-	for(auto p : dict)
-		if(diff(correct, p.second, d))
-			filter.push_back(p);
+	/// in the user's input are kept (the masks discard most of the words
+	/// without looking at their histogram)
+	for(long i = long(dict.size()) - 1; i >= 0; i--) {
+		const Entry<A>& e = dict[unsigned(i)];
+
+		if(!(e.mask & ~mask) && e.word.size() <= correct.size() && !e.removed && includes<A>(letters, e.histogram))
+			search.push_back(i);
+	}
+
+	return correct.size();
+}
+
+/**
+ * This function estimates the size of the subtree of each top-level branch
+ * of the search (the branch 'b' being the search of the anagrams starting
+ * with the word search[b]). The estimation is based on the number of words
+ * that can still be used in the branch and on the number of remaining
+ * letters. It only uses integers, so that it is the same on all machines.
+ *
+ * @param 	letters The histogram of the input
+ * @param 	length The number of letters of the input
+ * @param 	dict The dictionary of words
+ * @param 	search 	The position of the words that can be part of an anagram
+ * @param 	max The maximum number of words (-1 for no restriction)
+ * @return 	The estimated size of each top-level branch
+ */
+template<typename A>
+static vector<uint64_t> estimate_branches(const Histogram<A>& letters, size_t length, const BasicDictionary<A>& dict, const vector<long>& search, const int max) {
+	vector<uint64_t> sizes;
+	Histogram<A> d;
+
+	for(size_t b = 0; b < search.size(); b++) {
+		const Entry<A>& e = dict[unsigned(search[b])];
+		size_t rest = length - e.word.size();
+		uint64_t count = 0, size = 1;
+		size_t depth = (rest < 3) ? 1 : rest / 3;
+
+		subtract<A>(letters, e.histogram, d);
+
+		for(size_t i = 0; i <= b; i++) {
+			const Entry<A>& f = dict[unsigned(search[i])];
+
+			if(f.word.size() <= rest && includes<A>(d, f.histogram))
+				count++;
+		}
+
+		/// Each remaining word (of about 3 letters) multiplies the size of
+		/// the subtree by the number of usable words
+		if(max > 0 && depth > size_t(max - 1))
+			depth = size_t(max - 1);
+
+		if(rest > 0 && count > 0)
+			for(size_t i = 0; i < depth; i++)
+				size = (size > UINT64_MAX / count) ? UINT64_MAX : size * count;
+
+		sizes.push_back(size);
+	}
+
+	return sizes;
+}
+
+template<typename A>
+vector<vector<string>> anagrams(const string& input, const BasicDictionary<A>& dict, unsigned max) {
+	vector<vector<string>> results;
 
-	/// The positions of each word are initialized
-	for(unsigned i = 0; i < filter.size(); i++)
-		search.push_back(i);
+	anagrams(input, dict, max, [&results](const Anagram& a, const Positions&) { results.push_back(to_words(a)); });
+
+	return results;
+}
+
+template<typename A>
+void anagrams(const string& input, const BasicDictionary<A>& dict, unsigned max, const function<void(const Anagram&, const Positions&)>& found) {
+	int limit = int(max);
+
+	Histogram<A> letters;
+	size_t length;
+
+	vector<long> search;
+	Positions chosen;
+	Anagram anagram;
+
+	auto report = [&dict, &anagram, &found](const Positions& p) {
+		to_anagram(dict, p, anagram);
+		found(anagram, p);
+	};
+
+	length = prepare(input, dict, letters, search);
 
 	/// With a value of -1, the limit value will never reach 0 by decrementing
 	/// in recursive calls.
 	if(limit == 0)
 		limit = -1;
 
-	find(correct, filter, search, chosen, results, limit);
+	find(letters, length, dict, search, chosen, report, limit);
+}
 
-	return results;
+template<typename A>
+void ranked_anagrams(const string& input, const BasicDictionary<A>& dict, const Index& index, unsigned max, const function<void(const Anagram&, const Positions&)>& found) {
+	int limit = (max == 0) ? -1 : int(max);
+
+	Histogram<A> letters;
+	size_t length;
+
+	vector<long> search;
+	Positions chosen, sorted;
+	Anagram anagram;
+
+	length = prepare(input, dict, letters, search);
+
+	stable_sort(search.begin(), search.end(), [&index](long a, long b) { return index.scores[unsigned(a)] > index.scores[unsigned(b)]; });
+
+	/// The words of an anagram are put back in the order of the dictionary
+	auto canonical = [&dict, &sorted, &anagram, &found](const Positions& p) {
+		sorted = p;
+		sort(sorted.begin(), sorted.end());
+		to_anagram(dict, sorted, anagram);
+		found(anagram, sorted);
+	};
+
+	find_ranked(letters, length, dict, search.data(), search.data() + search.size(), chosen, canonical, limit);
+}
+
+template<typename A>
+void anagrams(const string& input, const BasicDictionary<A>& dict, unsigned max, Shard shard, const function<void(unsigned, const Positions&)>& found) {
+	int limit = (max == 0) ? -1 : int(max);
+
+	Histogram<A> letters, d;
+	size_t length;
+
+	vector<long> search;
+	Positions chosen;
+	unsigned branch = 0;
+
+	auto report = [&found, &branch](const Positions& p) { found(branch, p); };
+
+	if(shard.count == 0 || shard.id >= shard.count)
+		set_error("Shard is not valid.");
+
+	length = prepare(input, dict, letters, search);
+
+	/// The top-level branches are assigned to the shards from the largest to
+	/// the smallest, each one to the shard with the smallest load so far
+	vector<uint64_t> sizes = estimate_branches(letters, length, dict, search, limit);
+	vector<size_t> order(search.size());
+	vector<uint64_t> loads(shard.count, 0);
+	vector<bool> owned(search.size(), false);
+
+	for(size_t b = 0; b < order.size(); b++)
+		order[b] = b;
+
+	stable_sort(order.begin(), order.end(), [&sizes](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+
+	for(size_t b : order) {
+		unsigned s = unsigned(min_element(loads.begin(), loads.end()) - loads.begin());
+
+		loads[s] = (loads[s] > UINT64_MAX - sizes[b]) ? UINT64_MAX : loads[s] + sizes[b];
+		owned[b] = (s == shard.id);
+	}
+
+	/// The branches of the shard are explored in the same order as in 'find'
+	for(size_t b = 0; b < search.size(); b++) {
+		if(!owned[b])
+			continue;
+
+		const Entry<A>& e = dict[unsigned(search[b])];
+
+		chosen.assign(1, uint32_t(search[b]));
+		branch = unsigned(b);
+
+		if(e.word.size() < length) {
+			subtract<A>(letters, e.histogram, d);
+			find(d, length - e.word.size(), dict, vector<long>(search.begin(), search.begin() + long(b) + 1), chosen, report, limit - 1);
+		} else {
+			report(chosen);
+		}
+	}
+}
+
+template<typename A>
+Estimate estimate(const string& input, const BasicDictionary<A>& dict, unsigned max, unsigned samples) {
+	Estimate est = {0, 0, 0};
+
+	Histogram<A> letters, residual;
+	size_t length;
+	vector<long> search, fitting;
+
+	/// Number of words checked by the walks, and estimated number of words
+	/// checked by the search
+	double checks = 0, work = 0;
+
+	/// Same random walks for the same query
+	mt19937 generator(42);
+
+	auto start = chrono::steady_clock::now();
+
+	length = prepare(input, dict, letters, search);
+
+	auto middle = chrono::steady_clock::now();
+
+	/// Each sample is a random walk from the root of the search tree. Each
+	/// node of the walk stands for all the nodes at the same depth, whose
+	/// number is estimated by the product of the number of children of the
+	/// previous nodes of the walk (Knuth's estimator). The anagrams found at
+	/// a node are counted exactly, and the walk goes on with one of the
+	/// children that still have letters to use.
+	for(unsigned n = 0; n < samples; n++) {
+		Histogram<A> current = letters;
+		size_t left = length;
+		vector<long> list = search;
+		int limit = (max == 0) ? -1 : int(max);
+		double weight = 1;
+
+		while(limit != 0) {
+			vector<size_t> recursing;
+
+			est.nodes += weight;
+			work += weight * double(list.size());
+			checks += double(list.size());
+
+			fitting.clear();
+
+			for(long i : list) {
+				const Entry<A>& e = dict[unsigned(i)];
+
+				if(e.word.size() <= left && includes<A>(current, e.histogram)) {
+					fitting.push_back(i);
+
+					if(e.word.size() == left)
+						est.results += weight;
+					else if(limit != 1)
+						recursing.push_back(fitting.size() - 1);
+				}
+			}
+
+			if(recursing.empty())
+				break;
+
+			/// The search list of a child contains the fitting words up to
+			/// (and including) the word of the child
+			size_t k = recursing[uniform_int_distribution<size_t>(0, recursing.size() - 1)(generator)];
+			const Entry<A>& e = dict[unsigned(fitting[k])];
+
+			weight *= double(recursing.size());
+
+			subtract<A>(current, e.histogram, residual);
+			current = residual;
+			left -= e.word.size();
+			list.assign(fitting.begin(), fitting.begin() + long(k) + 1);
+			limit--;
+		}
+	}
+
+	auto time_prepare = chrono::duration<double, milli>(middle - start).count();
+	auto time = chrono::duration<double, milli>(chrono::steady_clock::now() - middle).count();
+
+	if(samples > 0) {
+		est.nodes /= samples;
+		est.results /= samples;
+
+		/// Checking a word costs about the same time in the walks and in
+		/// the search
+		est.time = time_prepare + ((checks > 0) ? work / samples * time / checks : 0);
+	}
+
+	return est;
+}
+
+template<typename A>
+bool valid_input(const string& input) {
+	string correct = input;
+	Histogram<A> letters;
+	Mask<A> mask;
+
+	return check_word<A>(correct, letters, mask);
+}
+
+template<typename A>
+vector<string> exact_anagrams(const string& input, const BasicDictionary<A>& dict, const Index& index) {
+	string correct = input;
+	Histogram<A> letters;
+	Mask<A> mask;
+
+	vector<string> words;
+
+	if(!check_word<A>(correct, letters, mask))
+		set_error("Input is not valid.");
+
+	for(unsigned i = index.slots[find_slot(letters, dict, index)]; i != NONE; i = index.next[i])
+		words.push_back(dict[i].word);
+
+	return words;
 }
+
+/// Explicit instantiations for the supported alphabets
+#define INSTANTIATE(A) \
+	template BasicDictionary<A> create_dictionary<A>(const string&); \
+	template BasicDictionary<A> create_dictionary<A>(const string&, Index&); \
+	template Index create_index<A>(const BasicDictionary<A>&); \
+	template bool insert_word<A>(BasicDictionary<A>&, Index&, const string&); \
+	template bool remove_word<A>(BasicDictionary<A>&, Index&, const string&); \
+	template vector<vector<string>> anagrams<A>(const string&, const BasicDictionary<A>&, unsigned); \
+	template void anagrams<A>(const string&, const BasicDictionary<A>&, unsigned, const function<void(const Anagram&, const Positions&)>&); \
+	template void anagrams<A>(const string&, const BasicDictionary<A>&, unsigned, Shard, const function<void(unsigned, const Positions&)>&); \
+	template void ranked_anagrams<A>(const string&, const BasicDictionary<A>&, const Index&, unsigned, const function<void(const Anagram&, const Positions&)>&); \
+	template Estimate estimate<A>(const string&, const BasicDictionary<A>&, unsigned, unsigned); \
+	template bool valid_input<A>(const string&); \
+	template vector<string> exact_anagrams<A>(const string&, const BasicDictionary<A>&, const Index&);
+
+INSTANTIATE(English)
+INSTANTIATE(Latin1)
+INSTANTIATE(Cyrillic)
@@ -4,8 +4,84 @@
 #include <vector>
 #include <utility>
 #include <string>
+#include <functional>
+#include <cstdint>
 
-typedef std::vector<std::pair<std::string, std::string>> Dictionary;
+#include "alphabet.hpp"
+
+/**
+ * An entry of a dictionary contains a word, its histogram and its mask
+ * (according to the alphabet 'A'). A word removed from the dictionary keeps
+ * its entry, marked as removed, so that the positions of the other words do
+ * not change (see 'remove_word').
+ */
+template<typename A>
+struct Entry {
+	std::string word;
+	Histogram<A> histogram;
+	Mask<A> mask;
+	bool removed = false;
+};
+
+template<typename A>
+using BasicDictionary = std::vector<Entry<A>>;
+
+typedef BasicDictionary<English> Dictionary;
+
+/**
+ * An index groups the words of a dictionary made of the same letters (i.e.
+ * sharing the same histogram). It is an open addressing hash table on the
+ * histograms: each slot contains the position (in the dictionary) of the
+ * first word of a group, and 'next' links each word to the next word of its
+ * group, in the same order as in the dictionary.
+ *
+ * The index also gives a score to each word: the quantity of information of
+ * its letters (according to their frequency in the dictionary), so that long
+ * words made of rare letters have the highest scores. The information of the
+ * letters is computed when the index is created, and kept for the words
+ * inserted afterwards.
+ *
+ * The removed words are not in any group, and are counted by 'nb_removed'.
+ */
+struct Index {
+	std::vector<unsigned> slots;
+	std::vector<unsigned> next;
+	std::vector<float> scores;
+	std::vector<double> information;
+	unsigned nb_removed = 0;
+};
+
+/// An anagram found by the search, as pointers to the words of the dictionary
+/// (valid as long as the dictionary exists).
+typedef std::vector<const std::string*> Anagram;
+
+/// The same anagram, as the positions of its words in the dictionary.
+typedef std::vector<uint32_t> Positions;
+
+/**
+ * The search of the anagrams can be split in several shards (for example to
+ * spread it over several processes). The top-level branches of the search
+ * (i.e. the first word of the anagrams) are distributed among the shards
+ * according to the estimated size of their subtrees. The distribution only
+ * depends on the input, the dictionary and the number of shards.
+ */
+struct Shard {
+	unsigned id; 	/// the number of the shard (from 0 to count - 1)
+	unsigned count; /// the total number of shards
+};
+
+/// An estimation of the cost of a query.
+struct Estimate {
+	double nodes; 	/// number of nodes of the search tree
+	double results; /// number of anagrams
+	double time; 	/// time of the search (in ms)
+};
+
+/**
+ * All the following functions are templates on the alphabet 'A' of the words
+ * (English by default). They are instantiated for the alphabets 'English',
+ * 'Latin1' and 'Cyrillic' (see 'alphabet.hpp').
+ */
 
 /**
  * This function initializes a dictionary (of type 'Dictionnary') from a list
@@ -16,7 +92,61 @@ typedef std::vector<std::pair<std::string, std::string>> Dictionary;
  * @param 	filename The path to the txt file containing the dictionary words
  * @return 	A dictionary containing all the words in the file in the same order
  */
-Dictionary create_dictionary(const std::string& filename);
+template<typename A = English>
+BasicDictionary<A> create_dictionary(const std::string& filename);
+
+/**
+ * This function does the same as the function above, but it also builds the
+ * index (of type 'Index') of the dictionary while reading the file.
+ *
+ * @param 	filename The path to the txt file containing the dictionary words
+ * @param	index The index to fill with the words of the dictionary
+ * @return 	A dictionary containing all the words in the file in the same order
+ */
+template<typename A = English>
+BasicDictionary<A> create_dictionary(const std::string& filename, Index& index);
+
+/**
+ * This function builds the index (of type 'Index') of an existing dictionary.
+ *
+ * @param	dict The dictionary of words
+ * @return	The index of the dictionary
+ */
+template<typename A>
+Index create_index(const BasicDictionary<A>& dict);
+
+/**
+ * This function inserts a word in a dictionary and in its index, without
+ * rebuilding the index: the word is appended to the dictionary, and to the
+ * group of the words made of the same letters (or to a new group). Only this
+ * group is updated, and the positions of the other words do not change (the
+ * dictionary is then no longer sorted alphabetically). The index is only
+ * rebuilt when its table is half full.
+ *
+ * @param	dict The dictionary of words
+ * @param	index The index of the dictionary
+ * @param	word The word to insert
+ * @return	A Boolean value indicating whether the word was inserted (false
+ *			if it is not valid or already in the dictionary)
+ */
+template<typename A>
+bool insert_word(BasicDictionary<A>& dict, Index& index, const std::string& word);
+
+/**
+ * This function removes a word from a dictionary and from its index, without
+ * rebuilding the index: the word is unlinked from its group and its entry is
+ * marked as removed, so that the positions of the other words do not change.
+ * Once half of the entries are removed, they are erased from the dictionary
+ * and the index is rebuilt.
+ *
+ * @param	dict The dictionary of words
+ * @param	index The index of the dictionary
+ * @param	word The word to remove
+ * @return	A Boolean value indicating whether the word was removed (false
+ *			if it is not in the dictionary)
+ */
+template<typename A>
+bool remove_word(BasicDictionary<A>& dict, Index& index, const std::string& word);
 
 /**
  * This function takes as input a string entered by the user, a dictionary
@@ -31,6 +161,98 @@ Dictionary create_dictionary(const std::string& filename);
  * @return 	A vector where each element is a vector containing a unique
  *			anagram of the string entered by the user
  */
-std::vector<std::vector<std::string>> anagrams(const std::string& input, const Dictionary& dict, unsigned max);
+template<typename A>
+std::vector<std::vector<std::string>> anagrams(const std::string& input, const BasicDictionary<A>& dict, unsigned max);
+
+/**
+ * This function does the same as the function above, but instead of
+ * returning all the anagrams at the end of the search, it calls 'found'
+ * with each anagram as soon as it is found (in the same order), given both
+ * as words and as positions in the dictionary.
+ *
+ * @param 	input The string entered by the user
+ * @param	dict The dictionary of words
+ * @param 	max The maximum number of words (0 for no restriction)
+ * @param 	found The function called with each anagram found
+ */
+template<typename A>
+void anagrams(const std::string& input, const BasicDictionary<A>& dict, unsigned max, const std::function<void(const Anagram&, const Positions&)>& found);
+
+/**
+ * This function does the same as the function above, but only for the
+ * top-level branches of the search assigned to the shard 'shard' (which must
+ * satisfy 'shard.id' < 'shard.count'). Each anagram is given with the number
+ * of the top-level branch it comes from: the anagrams of different shards
+ * are merged in the same order as the one of the function above by ordering
+ * them on this number (the anagrams of a branch being already in the right
+ * order).
+ *
+ * @param 	input The string entered by the user
+ * @param	dict The dictionary of words
+ * @param 	max The maximum number of words (0 for no restriction)
+ * @param 	shard The shard of the search to explore
+ * @param 	found The function called with the branch and the positions of
+ *			the words of each anagram found
+ */
+template<typename A>
+void anagrams(const std::string& input, const BasicDictionary<A>& dict, unsigned max, Shard shard, const std::function<void(unsigned, const Positions&)>& found);
+
+/**
+ * This function does the same as the second function above, but the words
+ * are explored by decreasing score (see 'Index'): the first anagrams found
+ * are made of long words with rare letters, and they are found sooner. The
+ * anagrams found are the same, only their order changes (the words of each
+ * anagram are still in the order of the dictionary).
+ *
+ * @param 	input The string entered by the user
+ * @param	dict The dictionary of words
+ * @param	index The index of the dictionary
+ * @param 	max The maximum number of words (0 for no restriction)
+ * @param 	found The function called with each anagram found
+ */
+template<typename A>
+void ranked_anagrams(const std::string& input, const BasicDictionary<A>& dict, const Index& index, unsigned max, const std::function<void(const Anagram&, const Positions&)>& found);
+
+/**
+ * This function estimates the cost of the search of the anagrams of a
+ * string, without doing it. The search tree is sampled with random walks
+ * (always the same ones for a given query), which gives an estimation of
+ * its number of nodes and of anagrams. The time of the search is estimated
+ * from the time spent on each node by the walks.
+ *
+ * @param 	input The string entered by the user
+ * @param	dict The dictionary of words
+ * @param 	max The maximum number of words (0 for no restriction)
+ * @param 	samples The number of random walks
+ * @return 	The estimated cost of the search
+ */
+template<typename A>
+Estimate estimate(const std::string& input, const BasicDictionary<A>& dict, unsigned max, unsigned samples = 256);
+
+/**
+ * This function checks whether a string entered by the user is a valid input
+ * (once its spaces are removed) for the functions above.
+ *
+ * @param 	input The string entered by the user
+ * @return 	A Boolean value indicating whether the input is valid
+ */
+template<typename A = English>
+bool valid_input(const std::string& input);
+
+/**
+ * This function takes as input a string entered by the user and the index of
+ * a dictionary. It checks whether the string of the user is valid. If this is
+ * the case, it returns all the words of the dictionary that are exact
+ * anagrams of this string (i.e. anagrams made of a single word). Contrary to
+ * 'anagrams', this only requires one lookup in the index.
+ *
+ * @param 	input The string entered by the user
+ * @param	dict The dictionary of words
+ * @param	index The index of the dictionary
+ * @return 	A vector containing the exact anagrams of the string entered by
+ *			the user, in the same order as in the dictionary
+ */
+template<typename A>
+std::vector<std::string> exact_anagrams(const std::string& input, const BasicDictionary<A>& dict, const Index& index);
 
 #endif
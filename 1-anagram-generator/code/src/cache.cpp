@@ -0,0 +1,223 @@
+/**
+ * Object-oriented programming projects - Project 1
+ * Anagram Generator
+ *
+ * This file is the implementation of the 'Cache' class.
+ *
+ * @author Maxime Meurisse (m.meurisse@student.uliege.be) - 20161278
+ * @version 2019.05.04
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "cache.hpp"
+
+using namespace std;
+
+/// Header of the cache files
+static const char CACHE_HEADER[] = {'A', 'N', 'A', 'C', 2};
+
+/**
+ * This function reads an anagram of a cache file.
+ *
+ * @param 	in The cache file (after its header)
+ * @param 	size The number of words of the dictionary
+ * @param 	length The number of letters of the query (i.e. the maximum number
+ *			of words of an anagram)
+ * @param 	words The positions of the words of the anagram
+ * @param 	total The number of anagrams of the file (read at its end)
+ * @return 	1 if an anagram was read, 0 at the end of the anagrams, and -1
+ *			if the file is not valid
+ */
+static int read_anagram(ifstream& in, size_t size, size_t length, vector<uint32_t>& words, uint64_t& total) {
+	uint32_t n;
+
+	if(!in.read(reinterpret_cast<char*>(&n), sizeof(n)))
+		return -1;
+
+	/// The anagrams are followed by an empty anagram and their number
+	if(n == 0)
+		return in.read(reinterpret_cast<char*>(&total), sizeof(total)) && in.peek() == EOF ? 0 : -1;
+
+	if(n > length)
+		return -1;
+
+	words.resize(n);
+
+	if(!in.read(reinterpret_cast<char*>(words.data()), long(n * sizeof(uint32_t))))
+		return -1;
+
+	for(uint32_t w : words)
+		if(w >= size)
+			return -1;
+
+	return 1;
+}
+
+Cache::Cache(const string& directory, uint64_t fp, const string& input, unsigned m) : fingerprint(fp), max(m) {
+	uint64_t h = fingerprint;
+	char name[17];
+
+	/// The signature of the input : its letters (without spaces), sorted
+	for(char c : input)
+		if(!isspace(static_cast<unsigned char>(c)))
+			signature += c;
+
+	sort(signature.begin(), signature.end());
+
+	for(char c : signature)
+		h = (h ^ static_cast<unsigned char>(c)) * 0x100000001b3;
+
+	h = (h ^ max) * 0x100000001b3;
+
+	snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(h));
+
+	mkdir(directory.c_str(), 0755);
+
+	filename = directory + "/" + name + ".bin";
+	tmp_filename = filename + "." + to_string(getpid());
+}
+
+Cache::~Cache() {
+	if(out.is_open()) {
+		out.close();
+		remove(tmp_filename.c_str());
+	}
+}
+
+bool Cache::contains(size_t size) const {
+	ifstream in(filename, ios::binary);
+
+	return check(in, size);
+}
+
+bool Cache::load(size_t size, const function<void(const vector<uint32_t>&)>& found) const {
+	ifstream in(filename, ios::binary);
+	vector<uint32_t> words;
+	uint64_t total = 0;
+
+	/// The whole file is checked before any anagram is given, so that a
+	/// damaged file gives no anagram (the query is then searched again)
+	if(!check(in, size))
+		return false;
+
+	while(read_anagram(in, size, signature.size(), words, total) == 1)
+		found(words);
+
+	return true;
+}
+
+void Cache::add(const vector<uint32_t>& words) {
+	if(!out.is_open()) {
+		out.open(tmp_filename, ios::binary | ios::trunc);
+		write_header();
+	}
+
+	uint32_t n = uint32_t(words.size());
+
+	out.write(reinterpret_cast<const char*>(&n), sizeof(n));
+	out.write(reinterpret_cast<const char*>(words.data()), long(words.size() * sizeof(uint32_t)));
+
+	nb_anagrams++;
+}
+
+bool Cache::commit() {
+	/// A query without anagram has a file with only a header
+	if(!out.is_open()) {
+		out.open(tmp_filename, ios::binary | ios::trunc);
+		write_header();
+	}
+
+	uint32_t end = 0;
+
+	out.write(reinterpret_cast<const char*>(&end), sizeof(end));
+	out.write(reinterpret_cast<const char*>(&nb_anagrams), sizeof(nb_anagrams));
+	out.close();
+
+	if(!out || rename(tmp_filename.c_str(), filename.c_str()) != 0) {
+		remove(tmp_filename.c_str());
+
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * This function writes the header of the cache file of the query.
+ */
+void Cache::write_header() {
+	uint32_t length = uint32_t(signature.size());
+
+	out.write(CACHE_HEADER, sizeof(CACHE_HEADER));
+	out.write(reinterpret_cast<const char*>(&fingerprint), sizeof(fingerprint));
+	out.write(reinterpret_cast<const char*>(&max), sizeof(max));
+	out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+	out.write(signature.data(), long(length));
+}
+
+/**
+ * This function checks that a cache file is the complete and valid file of
+ * the query, and moves back to its first anagram.
+ *
+ * @param 	in The cache file
+ * @param 	size The number of words of the dictionary
+ * @return 	A Boolean value indicating whether the file is valid
+ */
+bool Cache::check(ifstream& in, size_t size) const {
+	vector<uint32_t> words;
+	uint64_t nb = 0, total = 0;
+	int r;
+
+	if(!in || !read_header(in))
+		return false;
+
+	streampos begin = in.tellg();
+
+	while((r = read_anagram(in, size, signature.size(), words, total)) == 1)
+		nb++;
+
+	if(r < 0 || nb != total)
+		return false;
+
+	in.clear();
+	in.seekg(begin);
+
+	return true;
+}
+
+/**
+ * This function reads the header of a cache file and checks that it is the
+ * file of the query.
+ *
+ * @param 	in The cache file
+ * @return 	A Boolean value indicating whether the file is the one of the
+ *			query
+ */
+bool Cache::read_header(ifstream& in) const {
+	char header[sizeof(CACHE_HEADER)];
+	uint64_t fp;
+	uint32_t m, length;
+	string sig;
+
+	if(!in.read(header, sizeof(header)) || !equal(header, header + sizeof(header), CACHE_HEADER))
+		return false;
+
+	if(!in.read(reinterpret_cast<char*>(&fp), sizeof(fp)) || !in.read(reinterpret_cast<char*>(&m), sizeof(m)))
+		return false;
+
+	if(!in.read(reinterpret_cast<char*>(&length), sizeof(length)) || length != signature.size())
+		return false;
+
+	sig.resize(length);
+
+	if(!in.read(&sig[0], long(length)))
+		return false;
+
+	return fp == fingerprint && m == max && sig == signature;
+}
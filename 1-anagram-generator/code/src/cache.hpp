@@ -0,0 +1,115 @@
+#ifndef CACHE_HH
+#define CACHE_HH
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <functional>
+#include <cstdint>
+
+#include "anagrams.hpp"
+
+/**
+ * The 'Cache' class stores on disk the anagrams of the queries, so that a
+ * query that was already done (even with its letters in a different order
+ * or with different spaces) is answered by reading its anagrams back.
+ *
+ * A query is identified by the fingerprint of the dictionary, the signature
+ * of the input (its letters sorted alphabetically) and the maximum number of
+ * words. Each query is stored in its own file, named after a hash of these
+ * three values, so that a change of the dictionary automatically leads to
+ * other files. The file contains these values (checked when it is read),
+ * followed by each anagram as its number of words and the positions of its
+ * words in the dictionary (4 bytes each). The last anagram is followed by a
+ * number of words of 0 and by the number of anagrams (8 bytes).
+ *
+ * A file is first written under a temporary name and renamed once complete,
+ * so that an interrupted query never leaves an incomplete file.
+ */
+class Cache {
+public:
+	/**
+	 * @param 	directory The directory of the cache files (created if needed)
+	 * @param 	fingerprint The fingerprint of the dictionary
+	 * @param 	input The string entered by the user
+	 * @param 	max The maximum number of words (0 for no restriction)
+	 */
+	Cache(const std::string& directory, uint64_t fingerprint, const std::string& input, unsigned max);
+	~Cache();
+
+	Cache(const Cache&) = delete;
+	Cache& operator=(const Cache&) = delete;
+
+	/**
+	 * This function reads the anagrams of the query from the cache, if they
+	 * are available. Nothing is read from a damaged file.
+	 *
+	 * @param 	size The number of words of the dictionary
+	 * @param 	found The function called with the positions of the words of
+	 *			each anagram (in the same order as the one of the search)
+	 * @return 	A Boolean value indicating whether the query was in the cache
+	 */
+	bool load(size_t size, const std::function<void(const std::vector<uint32_t>&)>& found) const;
+
+	/**
+	 * This function checks whether the anagrams of the query are available
+	 * in the cache, without reading them.
+	 *
+	 * @param 	size The number of words of the dictionary
+	 * @return 	A Boolean value indicating whether the query is in the cache
+	 */
+	bool contains(size_t size) const;
+
+	/**
+	 * This function adds an anagram (found by the search) to the cache file
+	 * of the query.
+	 *
+	 * @param 	words The positions of the words of the anagram
+	 */
+	void add(const std::vector<uint32_t>& words);
+
+	/**
+	 * This function completes the cache file of the query, once all its
+	 * anagrams have been added.
+	 *
+	 * @return 	A Boolean value indicating whether the file was written
+	 */
+	bool commit();
+
+private:
+	uint64_t fingerprint;
+	std::string signature;
+	uint32_t max;
+
+	std::string filename, tmp_filename;
+	std::ofstream out;
+	uint64_t nb_anagrams = 0;
+
+	void write_header();
+	bool read_header(std::ifstream& in) const;
+	bool check(std::ifstream& in, size_t size) const;
+};
+
+/**
+ * This function computes the fingerprint of a dictionary, i.e. a hash of
+ * all its words (in order, a removed word being an empty word).
+ *
+ * @param 	dict The dictionary of words
+ * @return 	The fingerprint of the dictionary
+ */
+template<typename A>
+uint64_t fingerprint(const BasicDictionary<A>& dict) {
+	uint64_t h = 0xcbf29ce484222325;
+
+	for(const auto& e : dict) {
+		if(!e.removed)
+			for(char c : e.word)
+				h = (h ^ static_cast<unsigned char>(c)) * 0x100000001b3;
+
+		h = (h ^ '\n') * 0x100000001b3;
+	}
+
+	return h;
+}
+
+#endif
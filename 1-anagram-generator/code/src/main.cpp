@@ -1,21 +1,80 @@
 #include <string>
 #include <vector>
 #include <iostream>
-#include <fstream>
 #include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <cstdlib>
 
 #include "anagrams.hpp"
+#include "shard.hpp"
+#include "writer.hpp"
+#include "spill.hpp"
+#include "cache.hpp"
 
 using namespace std;
 
-int main() {
+int main(int argc, char* argv[]) {
     /// Variable declaration
     Dictionary dict;
+    Index index;
 
     string input;
-    unsigned max;
+    unsigned max, processes = 1;
+    bool binary = false, sorted = false, use_cache = false, use_estimate = false, ranked = false;
+    size_t memory = 64, first = 0;
+    double time_limit = 0;
 
-    vector<vector<string>> results;
+    size_t count = 0;
+
+    /// Retrieving options
+    for(int i = 1; i < argc; i++) {
+        string option = argv[i];
+
+        if(option == "-j" && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+            processes = unsigned(atoi(argv[++i]));
+        } else if(option == "-b") {
+            binary = true;
+        } else if(option == "-s") {
+            sorted = true;
+        } else if(option == "-m" && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+            memory = size_t(atoi(argv[++i]));
+        } else if(option == "-c") {
+            use_cache = true;
+        } else if(option == "-e") {
+            use_estimate = true;
+        } else if(option == "-t" && i + 1 < argc && atof(argv[i + 1]) > 0) {
+            use_estimate = true;
+            time_limit = atof(argv[++i]);
+        } else if(option == "-r") {
+            ranked = true;
+        } else if(option == "-n" && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+            first = size_t(atoi(argv[++i]));
+        } else {
+            cerr << "Usage : " << argv[0] << " [-j PROCESSES] [-b] [-s [-m MEMORY_MB]] [-c] [-e] [-t LIMIT_MS] [-r] [-n FIRST]" << endl;
+
+            return 1;
+        }
+    }
+
+    /// Dictionary creation, in the background while the user enters the
+    /// parameters (the index is used for single-word queries)
+    double time_dict = 0;
+    uint64_t dict_fingerprint = 0;
+
+    future<Dictionary> loading = async(launch::async, [&index, &time_dict, &dict_fingerprint, use_cache] {
+        auto start = chrono::steady_clock::now();
+
+        Dictionary d = create_dictionary("dictionaries/sowpods.txt", index);
+
+        if(use_cache)
+            dict_fingerprint = fingerprint(d);
+
+        time_dict = chrono::duration <double, milli> (chrono::steady_clock::now() - start).count();
+
+        return d;
+    });
 
     /// Retrieving parameters
     cout << "Enter a string : ";
@@ -24,43 +83,174 @@ int main() {
     cout << "Enter the maximum number of words (0 for no restriction) : ";
     cin >> max;
 
-    /// Dictionary creation
+    if(!valid_input(input)) {
+        cerr << "Input is not valid." << endl;
+
+        return 1;
+    }
+
+    /// Waiting for the end of the dictionary creation (if needed)
     auto start = chrono::steady_clock::now();
 
-    dict = create_dictionary("dictionaries/sowpods.txt");
+    dict = loading.get();
 
     auto end = chrono::steady_clock::now();
     auto diff = end - start;
-    auto time_dict = chrono::duration <double, milli> (diff).count();
+    auto time_wait = chrono::duration <double, milli> (diff).count();
+    auto time_hidden = (time_dict > time_wait) ? time_dict - time_wait : 0.0;
+
+    /// Estimation of the cost of the query (if asked) : expensive queries are
+    /// refused (if a limit is given) or split over all the cores (only if the
+    /// query needs neither the ranked search nor the first anagrams, which
+    /// are not available in the sharded search)
+    if(use_estimate && max != 1) {
+        Estimate est = estimate(input, dict, max);
+
+        cout << "Estimated number of anagrams : " << est.results << endl;
+        cout << "Estimated time (anagrams) : " << est.time << " ms" << endl;
+
+        if(time_limit > 0 && est.time > time_limit) {
+            cerr << "Query refused : estimated time exceeds " << time_limit << " ms." << endl;
+
+            return 1;
+        }
+
+        bool shardable = !ranked && first == 0;
+
+        if(est.time > 1000 && shardable && processes == 1 && thread::hardware_concurrency() > 1)
+            processes = thread::hardware_concurrency();
+    }
 
-    /// Finding anagrams
     start = chrono::steady_clock::now();
 
-    results = anagrams(input, dict, max);
+    /// Queries already done are read from the cache (if enabled). Ranked
+    /// searches are not cached, since their anagrams are in another order.
+    unique_ptr<Cache> cache;
+    bool cached = false;
+
+    if(use_cache && !ranked) {
+        cache = make_unique<Cache>("cache", dict_fingerprint, input, max);
+        cached = cache->contains(dict.size());
+    }
+
+    /// The processes of a sharded search are created before the thread of
+    /// the writer (cfr. 'Shards')
+    unique_ptr<Shards<English>> shards;
+
+    if(!cached && max != 1 && processes > 1 && !ranked)
+        shards = make_unique<Shards<English>>(input, dict, max, processes);
+
+    /// Finding anagrams (they are exported while the search goes on)
+    Writer out("outputs/" + input + "-" + to_string(max) + (binary ? ".bin" : ".txt"), binary ? Writer::BINARY : Writer::TEXT);
+
+    if(!out.is_open())
+        cerr << "Unable to export result" << endl;
+
+    /// Sorted anagrams are accumulated in a buffer of bounded size (spilled
+    /// to disk if needed) before being exported
+    unique_ptr<Spill> spill;
+
+    if(sorted)
+        spill = make_unique<Spill>(memory << 20, sorted);
+
+    auto export_anagram = [&out, &spill, &count](const Anagram& a) {
+        if(spill)
+            spill->add(a);
+        else
+            out.write(a);
+
+        count++;
+    };
+
+    if(cached) {
+        cached = cache->load(dict.size(), [&dict, &export_anagram](const vector<uint32_t>& words) {
+            Anagram a;
+
+            for(uint32_t w : words)
+                a.push_back(&dict[w].word);
+
+            export_anagram(a);
+        });
+    }
+
+    double time_first = 0;
+
+    /// The first anagrams are shown as soon as they are found, and all the
+    /// anagrams are added to the cache (if enabled)
+    function<void(const Anagram&, const Positions&)> found = [&cache, &export_anagram, &count, &time_first, &start, first](const Anagram& a, const Positions& p) {
+        if(count < first) {
+            cout << "Anagram :";
+
+            for(const string* w : a)
+                cout << " " << *w;
+
+            cout << endl;
+
+            if(count + 1 == first)
+                time_first = chrono::duration <double, milli> (chrono::steady_clock::now() - start).count();
+        }
+
+        export_anagram(a);
+
+        if(cache)
+            cache->add(p);
+    };
+
+    if(cached) {
+        cout << "Anagrams read from cache" << endl;
+    } else if(max == 1) {
+        vector<string> words = exact_anagrams(input, dict, index);
+        vector<vector<string>> exact;
+
+        /// Same order as the one of 'anagrams' (reverse order of the dictionary)
+        for(auto w = words.rbegin(); w != words.rend(); w++)
+            exact.push_back(vector<string>(1, *w));
+
+        for(const auto& e : exact)
+            if(spill)
+                spill->add(e);
+            else
+                out.write(e);
+
+        count += exact.size();
+
+        /// The words must remain valid until the writer has formatted them
+        out.wait();
+    } else {
+        /// The anagrams of the shards are exported while they are merged
+        if(shards)
+            shards->merge(found);
+        else if(ranked)
+            ranked_anagrams(input, dict, index, max, found);
+        else
+            anagrams(input, dict, max, found);
+
+        if(cache && !cache->commit())
+            cerr << "Unable to write cache" << endl;
+
+        if(first > 0 && count >= first)
+            cout << "Time (first " << first << " anagrams) : " << time_first << " ms" << endl;
+    }
 
     end = chrono::steady_clock::now();
     diff = end - start;
     auto time_results = chrono::duration <double, milli> (diff).count();
 
     /// Showing results
-    cout << "Number of anagrams : " << results.size() << endl;
-    cout << "Time (create_dictionary) : " << time_dict << " ms" << endl;
+    cout << "Number of anagrams : " << count << endl;
+    cout << "Time (create_dictionary) : " << time_dict << " ms (" << time_hidden << " ms hidden by input)" << endl;
     cout << "Time (anagrams) : " << time_results << " ms" << endl;
-    cout << "Time (total) : " << time_dict + time_results << " ms" << endl;
+    cout << "Time (total) : " << time_wait + time_results << " ms" << endl;
 
-    /// Exporting results
-    ofstream out("outputs/" + string(input) + "-" + to_string(max) + ".txt");
+    if(spill && spill->get_runs() > 0)
+        cout << "Number of runs written to disk : " << spill->get_runs() << endl;
 
-    if(!out) {
-        cerr << "Unable to export result" << endl;
-    } else {
-        for(vector<string> x : results) {
-            for(string y : x)
-                out << y << " ";
+    /// Exporting the last anagrams
+    if(spill)
+        spill->finish(out);
 
-            out << "\n";
-        }
-    }
+    if(out.is_open() && !out.close())
+        cerr << "Unable to export result" << endl;
 
     return 0;
 }
@@ -0,0 +1,224 @@
+/**
+ * Object-oriented programming projects - Project 1
+ * Anagram Generator
+ *
+ * This file is the implementation of the 'Shards' class, used to split the
+ * search of the anagrams over several processes.
+ *
+ * @author Maxime Meurisse (m.meurisse@student.uliege.be) - 20161278
+ * @version 2019.05.04
+ */
+
+#include <iostream>
+#include <fstream>
+#include <queue>
+#include <functional>
+#include <cstdio>
+#include <cstdlib>
+#include <csignal>
+
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "shard.hpp"
+
+using namespace std;
+
+[[noreturn]] static void set_error(const string& msg) {
+	cerr << msg << endl;
+	exit(EXIT_FAILURE);
+}
+
+/**
+ * This function writes an anagram found by a shard in its file.
+ *
+ * @param 	out The file of the shard
+ * @param 	branch The number of the top-level branch of the anagram
+ * @param 	positions The positions of the words of the anagram
+ */
+static void write_anagram(ostream& out, unsigned branch, const Positions& positions) {
+	out << branch;
+
+	for(uint32_t p : positions)
+		out << ' ' << p;
+
+	out << '\n';
+}
+
+/**
+ * This function reads the next anagram of the file of a shard.
+ *
+ * @param 	in The file of the shard
+ * @param 	size The number of words of the dictionary
+ * @param 	branch The number of the top-level branch of the anagram
+ * @param 	positions The positions of the words of the anagram
+ * @return 	1 if an anagram was read, 0 at the end of the file, and -1 if
+ *			the file is not valid
+ */
+static int read_anagram(istream& in, size_t size, unsigned& branch, Positions& positions) {
+	string line;
+	char* end;
+
+	if(!getline(in, line))
+		return in.eof() ? 0 : -1;
+
+	const char* p = line.c_str();
+
+	branch = unsigned(strtoul(p, &end, 10));
+	positions.clear();
+
+	if(end == p)
+		return -1;
+
+	for(p = end; *p; p = end) {
+		unsigned long w = strtoul(p, &end, 10);
+
+		if(end == p || w >= size)
+			return -1;
+
+		positions.push_back(uint32_t(w));
+	}
+
+	return positions.empty() ? -1 : 1;
+}
+
+template<typename A>
+Shards<A>::Shards(const string& input, const BasicDictionary<A>& d, unsigned max, unsigned count) : dict(d) {
+	/// The input is checked once, before creating the processes
+	if(!valid_input<A>(input))
+		set_error("Input is not valid.");
+
+	for(unsigned s = 0; s < count; s++) {
+		char name[] = "/tmp/anagrams-XXXXXX";
+		int fd = mkstemp(name);
+
+		if(fd < 0)
+			fail("Unable to create temporary file.");
+
+		close(fd);
+		files.push_back(name);
+
+		pid_t pid = fork();
+
+		if(pid < 0)
+			fail("Unable to create process.");
+
+		/// Each child explores its shard and writes its anagrams in its file
+		/// as they are found
+		if(pid == 0) {
+			ofstream out(name);
+
+			anagrams(input, dict, max, Shard{s, count}, [&out](unsigned branch, const Positions& p) {
+				write_anagram(out, branch, p);
+			});
+
+			out.close();
+
+			_exit(out ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+
+		pids.push_back(pid);
+	}
+}
+
+template<typename A>
+Shards<A>::~Shards() {
+	stop();
+}
+
+template<typename A>
+void Shards<A>::merge(const function<void(const Anagram&, const Positions&)>& found) {
+	int status;
+
+	while(!pids.empty()) {
+		pid_t pid = pids.back();
+
+		if(waitpid(pid, &status, 0) < 0)
+			fail("A process failed to explore its shard.");
+
+		pids.pop_back();
+
+		if(!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+			fail("A process failed to explore its shard.");
+	}
+
+	/// Each file is sorted on the branch numbers, and a branch belongs to a
+	/// single shard: the file whose next anagram has the smallest branch
+	/// number is always the next one
+	typedef pair<unsigned, size_t> Head;
+
+	vector<ifstream> in(files.size());
+	vector<Positions> positions(files.size());
+	priority_queue<Head, vector<Head>, greater<Head>> heads;
+	Anagram anagram;
+	unsigned branch;
+
+	auto next = [&](size_t s) {
+		int r = read_anagram(in[s], dict.size(), branch, positions[s]);
+
+		if(r < 0)
+			fail("Unable to read temporary file.");
+
+		if(r > 0)
+			heads.push(make_pair(branch, s));
+	};
+
+	for(size_t s = 0; s < files.size(); s++) {
+		in[s].open(files[s]);
+
+		if(!in[s])
+			fail("Unable to read temporary file.");
+
+		next(s);
+	}
+
+	while(!heads.empty()) {
+		size_t s = heads.top().second;
+
+		heads.pop();
+		anagram.clear();
+
+		for(uint32_t p : positions[s])
+			anagram.push_back(&dict[p].word);
+
+		found(anagram, positions[s]);
+		next(s);
+	}
+
+	stop();
+}
+
+/**
+ * This function kills the processes still running (and waits for them), and
+ * removes the temporary files.
+ */
+template<typename A>
+void Shards<A>::stop() {
+	for(pid_t pid : pids) {
+		kill(pid, SIGKILL);
+		waitpid(pid, nullptr, 0);
+	}
+
+	for(const string& name : files)
+		remove(name.c_str());
+
+	pids.clear();
+	files.clear();
+}
+
+/**
+ * This function stops the processes and removes the temporary files before
+ * reporting an error.
+ *
+ * @param 	msg The message of the error
+ */
+template<typename A>
+void Shards<A>::fail(const string& msg) {
+	stop();
+	set_error(msg);
+}
+
+/// Explicit instantiations for the supported alphabets
+template class Shards<English>;
+template class Shards<Latin1>;
+template class Shards<Cyrillic>;
@@ -0,0 +1,62 @@
+#ifndef SHARD_HH
+#define SHARD_HH
+
+#include <string>
+#include <vector>
+#include <functional>
+
+#include <sys/types.h>
+
+#include "anagrams.hpp"
+
+/**
+ * The 'Shards' class does the same search as 'anagrams', but it splits it in
+ * several shards, each one explored by a different process (created with
+ * 'fork'). Each process writes the anagrams of its shard in a temporary file
+ * as soon as they are found (each line containing the number of the
+ * top-level branch of an anagram followed by the positions of its words).
+ * Once all the processes are done, the files are merged on the branch
+ * numbers, so that the anagrams are given in the same order as the one of
+ * 'anagrams' without being all kept in memory.
+ *
+ * As a process created by 'fork' only keeps the thread that created it, the
+ * processes are created by the constructor, which must be called before any
+ * other thread is started (for example the thread of a 'Writer'). If an
+ * error occurs (or if the anagrams are not merged), the processes still
+ * running are killed and the temporary files are removed.
+ */
+template<typename A>
+class Shards {
+public:
+	/**
+	 * @param 	input The string entered by the user
+	 * @param	dict The dictionary of words
+	 * @param 	max The maximum number of words (0 for no restriction)
+	 * @param 	count The number of processes
+	 */
+	Shards(const std::string& input, const BasicDictionary<A>& dict, unsigned max, unsigned count);
+	~Shards();
+
+	Shards(const Shards&) = delete;
+	Shards& operator=(const Shards&) = delete;
+
+	/**
+	 * This function waits for the end of the processes, and merges the
+	 * anagrams of their shards.
+	 *
+	 * @param 	found The function called with each anagram found
+	 */
+	void merge(const std::function<void(const Anagram&, const Positions&)>& found);
+
+private:
+	const BasicDictionary<A>& dict;
+
+	/// Temporary files of the shards, and processes not waited for yet
+	std::vector<std::string> files;
+	std::vector<pid_t> pids;
+
+	void stop();
+	[[noreturn]] void fail(const std::string& msg);
+};
+
+#endif
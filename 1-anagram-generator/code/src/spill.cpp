@@ -0,0 +1,313 @@
+/**
+ * Object-oriented programming projects - Project 1
+ * Anagram Generator
+ *
+ * This file is the implementation of the 'Spill' class.
+ *
+ * @author Maxime Meurisse (m.meurisse@student.uliege.be) - 20161278
+ * @version 2019.05.04
+ */
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <queue>
+#include <functional>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+
+#include <unistd.h>
+
+#include "spill.hpp"
+
+using namespace std;
+
+[[noreturn]] static void set_error(const string& msg) {
+	cerr << msg << endl;
+	exit(EXIT_FAILURE);
+}
+
+/**
+ * This function compares two lines of a buffer (each one ending with an end
+ * of line).
+ *
+ * @param 	a The first line
+ * @param 	b The second line
+ * @return 	A Boolean value indicating whether the first line comes before
+ *			the second one alphabetically
+ */
+static bool less_line(const char* a, const char* b) {
+	while(*a == *b && *a != '\n') {
+		a++;
+		b++;
+	}
+
+	return static_cast<unsigned char>(*a) < static_cast<unsigned char>(*b);
+}
+
+/**
+ * This function returns the size of a line of a buffer (without its end of
+ * line).
+ *
+ * @param 	l The line
+ * @return 	The size of the line
+ */
+static size_t line_size(const char* l) {
+	const char* end = l;
+
+	while(*end != '\n')
+		end++;
+
+	return size_t(end - l);
+}
+
+Spill::Spill(size_t mem, bool sort) : memory(mem), sorted(sort) {
+	buffer.reserve(memory);
+}
+
+Spill::~Spill() {
+	for(const string& name : runs)
+		remove(name.c_str());
+}
+
+void Spill::add(const Anagram& anagram) {
+	line.clear();
+
+	for(const string* w : anagram) {
+		line += *w;
+		line += ' ';
+	}
+
+	add_line();
+}
+
+void Spill::add(const vector<string>& anagram) {
+	line.clear();
+
+	for(const string& w : anagram) {
+		line += w;
+		line += ' ';
+	}
+
+	add_line();
+}
+
+/**
+ * This function adds the current line to the buffer, after having written
+ * the content of the buffer in a run if there is no more space.
+ */
+void Spill::add_line() {
+	line += '\n';
+
+	if(!lines.empty() && buffer.size() + line.size() + (lines.size() + 1) * sizeof(size_t) > memory)
+		spill();
+
+	lines.push_back(buffer.size());
+	buffer.insert(buffer.end(), line.begin(), line.end());
+}
+
+/**
+ * This function writes the content of the buffer in a new run (sorted if
+ * needed), and empties the buffer.
+ */
+void Spill::spill() {
+	string name = create_run();
+	const char* data = buffer.data();
+
+	runs.push_back(name);
+
+	if(sorted)
+		sort(lines.begin(), lines.end(), [data](size_t a, size_t b) {
+			return less_line(data + a, data + b);
+		});
+
+	ofstream out(name, ios::binary);
+
+	for(size_t l : lines)
+		out.write(data + l, long(line_size(data + l) + 1));
+
+	if(!out)
+		set_error("Unable to write temporary file.");
+
+	buffer.clear();
+	lines.clear();
+}
+
+void Spill::finish(Writer& out) {
+	/// Everything fits in memory : the lines are exported from the buffer
+	if(runs.empty()) {
+		const char* data = buffer.data();
+
+		if(sorted)
+			sort(lines.begin(), lines.end(), [data](size_t a, size_t b) {
+				return less_line(data + a, data + b);
+			});
+
+		for(size_t l : lines)
+			emit(data + l, line_size(data + l), out);
+
+		flush_block(out);
+
+		buffer.clear();
+		lines.clear();
+
+		return;
+	}
+
+	if(!lines.empty())
+		spill();
+
+	/// The buffer is not needed anymore during the merge
+	vector<char>().swap(buffer);
+	vector<size_t>().swap(lines);
+
+	/// Groups of runs are merged into new runs until they can all be open
+	/// at the same time (the order of the runs is kept)
+	while(runs.size() > MAX_RUNS) {
+		vector<string> merged;
+
+		for(size_t first = 0; first < runs.size(); first += MAX_RUNS) {
+			vector<string> group(runs.begin() + long(first), runs.begin() + long(min(first + MAX_RUNS, runs.size())));
+			string name = create_run();
+			ofstream file(name, ios::binary);
+
+			merge(group, [&file](const string& l) {
+				file << l << '\n';
+			});
+
+			if(!file)
+				set_error("Unable to write temporary file.");
+
+			for(const string& g : group)
+				remove(g.c_str());
+
+			merged.push_back(name);
+		}
+
+		runs.swap(merged);
+	}
+
+	merge(runs, [this, &out](const string& l) {
+		emit(l.data(), l.size(), out);
+	});
+
+	flush_block(out);
+
+	for(const string& name : runs)
+		remove(name.c_str());
+
+	runs.clear();
+}
+
+/**
+ * This function creates a new temporary file for a run.
+ *
+ * @return 	The name of the file
+ */
+string Spill::create_run() {
+	char name[] = "/tmp/anagrams-run-XXXXXX";
+	int fd = mkstemp(name);
+
+	if(fd < 0)
+		set_error("Unable to create temporary file.");
+
+	close(fd);
+
+	return name;
+}
+
+/**
+ * This function merges runs (sorted if needed) or concatenates them (in
+ * their order otherwise), and gives each line (without its end of line) to
+ * a function.
+ *
+ * @param 	names The files of the runs
+ * @param 	found The function called with each line
+ */
+void Spill::merge(const vector<string>& names, const function<void(const string&)>& found) {
+	vector<ifstream> files(names.size());
+	string l;
+
+	for(size_t r = 0; r < names.size(); r++) {
+		files[r].open(names[r], ios::binary);
+
+		if(!files[r])
+			set_error("Unable to read temporary file.");
+	}
+
+	if(!sorted) {
+		/// The runs are simply concatenated
+		for(auto& f : files)
+			while(getline(f, l))
+				found(l);
+	} else {
+		/// k-way merge of the sorted runs (on equal lines, the first run wins)
+		typedef pair<string, size_t> Head;
+		priority_queue<Head, vector<Head>, greater<Head>> heads;
+
+		for(size_t r = 0; r < files.size(); r++)
+			if(getline(files[r], l))
+				heads.push(make_pair(l, r));
+
+		while(!heads.empty()) {
+			Head h = heads.top();
+			heads.pop();
+
+			found(h.first);
+
+			if(getline(files[h.second], l))
+				heads.push(make_pair(l, h.second));
+		}
+	}
+
+	for(auto& f : files)
+		if(!f.eof())
+			set_error("Unable to read temporary file.");
+}
+
+/**
+ * This function gives an anagram (as a line, without its end of line) to a
+ * writer. The anagrams are kept in a block until the writer has formatted
+ * them, the size of the block being bounded by the size of the buffer.
+ *
+ * @param 	l The line of the anagram
+ * @param 	size The size of the line
+ * @param 	out The writer
+ */
+void Spill::emit(const char* l, size_t size, Writer& out) {
+	vector<string> words;
+	const char* end = l + size;
+
+	while(l < end) {
+		const char* space = static_cast<const char*>(memchr(l, ' ', size_t(end - l)));
+
+		if(!space)
+			space = end;
+
+		words.push_back(string(l, space));
+		l = space + 1;
+	}
+
+	block_size += size + sizeof(words);
+	block.push_back(move(words));
+
+	if(block_size > memory / 2)
+		flush_block(out);
+}
+
+/**
+ * This function gives the anagrams of the block to a writer, and empties
+ * the block once the writer has formatted them.
+ *
+ * @param 	out The writer
+ */
+void Spill::flush_block(Writer& out) {
+	for(const auto& a : block)
+		out.write(a);
+
+	out.wait();
+
+	block.clear();
+	block_size = 0;
+}
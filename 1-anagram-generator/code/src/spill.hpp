@@ -0,0 +1,92 @@
+#ifndef SPILL_HH
+#define SPILL_HH
+
+#include <string>
+#include <vector>
+#include <functional>
+
+#include "anagrams.hpp"
+#include "writer.hpp"
+
+/**
+ * The 'Spill' class accumulates anagrams while keeping the memory it uses
+ * bounded, whatever the number of anagrams.
+ *
+ * The anagrams are stored (as text lines) in a buffer of fixed size. Each
+ * time the buffer is full, its content is written in a temporary file (a
+ * run), sorted if a global order is needed. At the end, the runs are merged
+ * (or simply concatenated if no order is needed) and given to a writer. At
+ * most 'MAX_RUNS' runs are open at the same time : if there are more, groups
+ * of runs are first merged into larger runs.
+ */
+class Spill {
+public:
+	/**
+	 * @param 	memory The size of the buffer (in bytes)
+	 * @param 	sorted Whether the anagrams must be sorted alphabetically
+	 *			(otherwise, they are kept in the order in which they are added)
+	 */
+	Spill(size_t memory, bool sorted);
+	~Spill();
+
+	Spill(const Spill&) = delete;
+	Spill& operator=(const Spill&) = delete;
+
+	/**
+	 * These functions add an anagram.
+	 *
+	 * @param 	anagram The anagram to add
+	 */
+	void add(const Anagram& anagram);
+	void add(const std::vector<std::string>& anagram);
+
+	/**
+	 * This function gives all the anagrams added so far to a writer, and
+	 * removes the temporary files.
+	 *
+	 * @param 	out The writer to which the anagrams are given
+	 */
+	void finish(Writer& out);
+
+	/**
+	 * This function returns the number of runs written so far.
+	 *
+	 * @return 	The number of runs
+	 */
+	size_t get_runs() const { return runs.size(); }
+
+private:
+	/// Maximum number of runs merged at the same time
+	static const size_t MAX_RUNS = 64;
+
+	size_t memory;
+	bool sorted;
+
+	/// Buffer of the anagrams (each one as a line, each word followed by a
+	/// space), and position of each line in the buffer
+	std::vector<char> buffer;
+	std::vector<size_t> lines;
+
+	/// Temporary files containing the runs
+	std::vector<std::string> runs;
+
+	/// Line being built by 'add'
+	std::string line;
+
+	/// Anagrams given to the writer and not yet written (their words must
+	/// remain valid until the writer has formatted them)
+	std::vector<std::vector<std::string>> block;
+	size_t block_size = 0;
+
+	void add_line();
+
+	void spill();
+
+	std::string create_run();
+	void merge(const std::vector<std::string>& names, const std::function<void(const std::string&)>& found);
+
+	void emit(const char* l, size_t size, Writer& out);
+	void flush_block(Writer& out);
+};
+
+#endif
@@ -0,0 +1,120 @@
+/**
+ * Object-oriented programming projects - Project 1
+ * Anagram Generator
+ *
+ * This file is the implementation of the 'Store' class.
+ *
+ * @author Maxime Meurisse (m.meurisse@student.uliege.be) - 20161278
+ * @version 2019.05.04
+ */
+
+#include <atomic>
+
+#include "store.hpp"
+
+using namespace std;
+
+template<typename A>
+Store<A>::Store(const string& filename) {
+	auto snapshot = make_shared<Snapshot>();
+
+	snapshot->version = 0;
+	snapshot->dict = create_dictionary<A>(filename, snapshot->index);
+
+	current = snapshot;
+}
+
+template<typename A>
+shared_ptr<const typename Store<A>::Snapshot> Store<A>::get() const {
+	return atomic_load(&current);
+}
+
+template<typename A>
+size_t Store<A>::update(const vector<string>& added, const vector<string>& removed) {
+	lock_guard<mutex> lock(writing);
+
+	Change change(added, removed);
+	shared_ptr<Snapshot> snapshot;
+
+	/// The changes are applied to the previous snapshot if no query uses it
+	/// anymore (it can't be taken again, since it is not the current one),
+	/// and to a copy of the current snapshot otherwise
+	if(previous && previous.use_count() == 1) {
+		/// 'use_count' is a relaxed load : the fence orders the reads of the
+		/// last query (released with its reference) before the changes
+		atomic_thread_fence(memory_order_acquire);
+
+		snapshot = move(previous);
+
+		for(const Change& c : changes)
+			apply(*snapshot, c);
+	} else {
+		snapshot = make_shared<Snapshot>(*current);
+	}
+
+	changes.clear();
+
+	size_t nb = apply(*snapshot, change);
+
+	/// Without any change, the snapshot is the same as the current one
+	if(nb == 0) {
+		previous = snapshot;
+
+		return 0;
+	}
+
+	previous = const_pointer_cast<Snapshot>(current);
+	changes.push_back(move(change));
+
+	publish(snapshot);
+
+	return nb;
+}
+
+template<typename A>
+void Store<A>::reload(const string& filename) {
+	lock_guard<mutex> lock(writing);
+
+	auto snapshot = make_shared<Snapshot>();
+
+	snapshot->dict = create_dictionary<A>(filename, snapshot->index);
+
+	previous = nullptr;
+	changes.clear();
+
+	publish(snapshot);
+}
+
+/**
+ * This function applies changes to a snapshot (the words are removed first).
+ *
+ * @param 	snapshot The snapshot
+ * @param 	change The words to add and the words to remove
+ * @return 	The number of words actually added or removed
+ */
+template<typename A>
+size_t Store<A>::apply(Snapshot& snapshot, const Change& change) {
+	size_t nb = 0;
+
+	for(const string& w : change.second)
+		if(remove_word(snapshot.dict, snapshot.index, w))
+			nb++;
+
+	for(const string& w : change.first)
+		if(insert_word(snapshot.dict, snapshot.index, w))
+			nb++;
+
+	return nb;
+}
+
+template<typename A>
+void Store<A>::publish(shared_ptr<Snapshot> snapshot) {
+	snapshot->version = current->version + 1;
+
+	atomic_store(&current, shared_ptr<const Snapshot>(snapshot));
+}
+
+/// Explicit instantiations for the supported alphabets
+template class Store<English>;
+template class Store<Latin1>;
+template class Store<Cyrillic>;
@@ -0,0 +1,90 @@
+#ifndef STORE_HH
+#define STORE_HH
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+
+#include "anagrams.hpp"
+
+/**
+ * The 'Store' class holds a dictionary and its index that can be updated
+ * while queries are running on them (for example by a long-running service
+ * whose word list changes).
+ *
+ * The dictionary is published as an immutable snapshot (read-copy-update):
+ * a query takes the current snapshot and keeps its consistent view of the
+ * dictionary as long as it holds it, even if the dictionary is updated in
+ * the meantime. An update applies the changes to another snapshot
+ * (incrementally, see 'insert_word' and 'remove_word') and publishes it
+ * atomically with a new version number.
+ *
+ * The previous snapshot is kept with the changes made since: once its last
+ * query is done, the next update brings it up to date with these changes
+ * and reuses it, instead of copying the current snapshot (which is only done
+ * if the previous one is still in use).
+ *
+ * Updates are serialised among themselves, but never block the queries.
+ */
+template<typename A>
+class Store {
+public:
+	/// A version of the dictionary and of its index.
+	struct Snapshot {
+		uint64_t version;
+		BasicDictionary<A> dict;
+		Index index;
+	};
+
+	/**
+	 * @param 	filename The path to the txt file containing the dictionary words
+	 */
+	Store(const std::string& filename);
+
+	Store(const Store&) = delete;
+	Store& operator=(const Store&) = delete;
+
+	/**
+	 * This function returns the current snapshot of the dictionary.
+	 *
+	 * @return 	The current snapshot
+	 */
+	std::shared_ptr<const Snapshot> get() const;
+
+	/**
+	 * This function adds words to the dictionary and removes others from it,
+	 * and publishes the result as a new snapshot (if anything changed).
+	 *
+	 * @param 	added The words to add
+	 * @param 	removed The words to remove
+	 * @return 	The number of words actually added or removed
+	 */
+	size_t update(const std::vector<std::string>& added, const std::vector<std::string>& removed);
+
+	/**
+	 * This function replaces the dictionary by the words of a txt file, and
+	 * publishes it as a new snapshot.
+	 *
+	 * @param 	filename The path to the txt file containing the dictionary words
+	 */
+	void reload(const std::string& filename);
+
+private:
+	typedef std::pair<std::vector<std::string>, std::vector<std::string>> Change;
+
+	std::shared_ptr<const Snapshot> current;
+	std::mutex writing;
+
+	/// Previous snapshot, and the changes made since (words added and removed)
+	std::shared_ptr<Snapshot> previous;
+	std::vector<Change> changes;
+
+	static size_t apply(Snapshot& snapshot, const Change& change);
+
+	void publish(std::shared_ptr<Snapshot> snapshot);
+};
+
+#endif
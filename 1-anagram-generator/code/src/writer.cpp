@@ -0,0 +1,264 @@
+/**
+ * Object-oriented programming projects - Project 1
+ * Anagram Generator
+ *
+ * This file is the implementation of the 'Writer' class.
+ *
+ * @author Maxime Meurisse (m.meurisse@student.uliege.be) - 20161278
+ * @version 2019.05.04
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "writer.hpp"
+
+using namespace std;
+
+/// Header of the binary format
+static const char BINARY_HEADER[] = {'A', 'N', 'A', 'G', 2};
+
+/**
+ * This function returns the number of bytes of a number written as a varint
+ * (7 bits per byte, the highest bit indicating that another byte follows).
+ *
+ * @param 	n The number
+ * @return 	The number of bytes of the varint
+ */
+static size_t varint_size(size_t n) {
+	size_t size = 1;
+
+	for(; n >= 0x80; n >>= 7)
+		size++;
+
+	return size;
+}
+
+/**
+ * This function writes a number as a varint (see 'varint_size').
+ *
+ * @param 	out The position where the varint is written (moved after it)
+ * @param 	n The number
+ */
+static void put_varint(char*& out, size_t n) {
+	for(; n >= 0x80; n >>= 7)
+		*out++ = char((n & 0x7f) | 0x80);
+
+	*out++ = char(n);
+}
+
+Writer::Writer(const string& filename, format f) : fmt(f), buffer(BUFFER_SIZE) {
+	fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+	if(fd < 0)
+		return;
+
+	if(fmt == BINARY) {
+		memcpy(buffer.data(), BINARY_HEADER, sizeof(BINARY_HEADER));
+		used = sizeof(BINARY_HEADER);
+	}
+
+	batch.reserve(BATCH_SIZE);
+	thread = std::thread(&Writer::run, this);
+}
+
+Writer::~Writer() {
+	close();
+}
+
+void Writer::write(const Anagram& anagram) {
+	if(fd < 0)
+		return;
+
+	batch.insert(batch.end(), anagram.begin(), anagram.end());
+	batch.push_back(nullptr);
+
+	if(batch.size() >= BATCH_SIZE)
+		push_batch();
+}
+
+void Writer::write(const vector<string>& anagram) {
+	if(fd < 0)
+		return;
+
+	for(const string& w : anagram)
+		batch.push_back(&w);
+
+	batch.push_back(nullptr);
+
+	if(batch.size() >= BATCH_SIZE)
+		push_batch();
+}
+
+void Writer::wait() {
+	if(fd < 0)
+		return;
+
+	push_batch();
+
+	unique_lock<std::mutex> lock(mutex);
+
+	cond.wait(lock, [this] { return queue.empty() && !busy; });
+}
+
+bool Writer::close() {
+	if(fd < 0)
+		return false;
+
+	push_batch();
+
+	{
+		lock_guard<std::mutex> lock(mutex);
+		done = true;
+	}
+
+	cond.notify_all();
+	thread.join();
+
+	flush();
+
+	bool ok = !error && ::close(fd) == 0;
+	fd = -1;
+
+	return ok;
+}
+
+/**
+ * This function gives the current batch to the thread, and takes a new one
+ * (waiting if too many batches are already waiting to be written).
+ */
+void Writer::push_batch() {
+	unique_lock<std::mutex> lock(mutex);
+
+	cond.wait(lock, [this] { return queue.size() < QUEUE_SIZE; });
+
+	queue.push_back(move(batch));
+
+	if(free_batches.empty()) {
+		batch = Batch();
+		batch.reserve(BATCH_SIZE);
+	} else {
+		batch = move(free_batches.back());
+		free_batches.pop_back();
+	}
+
+	lock.unlock();
+	cond.notify_all();
+}
+
+/**
+ * This function is run by the thread of the writer: it formats the batches
+ * in the order in which they were given, until the writer is closed.
+ */
+void Writer::run() {
+	Batch b;
+
+	while(true) {
+		{
+			unique_lock<std::mutex> lock(mutex);
+
+			cond.wait(lock, [this] { return done || !queue.empty(); });
+
+			if(queue.empty())
+				return;
+
+			b = move(queue.front());
+			queue.pop_front();
+
+			busy = true;
+		}
+
+		cond.notify_all();
+
+		format_batch(b);
+
+		b.clear();
+
+		{
+			lock_guard<std::mutex> lock(mutex);
+
+			free_batches.push_back(move(b));
+			busy = false;
+		}
+
+		cond.notify_all();
+	}
+}
+
+/**
+ * This function formats the anagrams of a batch in the buffer, and writes
+ * the buffer in the file each time it is full.
+ *
+ * @param 	b The batch to format
+ */
+void Writer::format_batch(const Batch& b) {
+	auto it = b.begin();
+
+	while(it != b.end()) {
+		auto end = find(it, b.end(), nullptr);
+		size_t size = 1;
+
+		/// Size of the formatted anagram
+		if(fmt == TEXT) {
+			for(auto w = it; w != end; w++)
+				size += (*w)->size() + 1;
+		} else {
+			size = varint_size(size_t(end - it));
+
+			for(auto w = it; w != end; w++)
+				size += varint_size((*w)->size()) + (*w)->size();
+		}
+
+		if(used + size > buffer.size())
+			flush();
+
+		if(size > buffer.size())
+			buffer.resize(size);
+
+		char* out = buffer.data() + used;
+
+		if(fmt == TEXT) {
+			for(auto w = it; w != end; w++) {
+				memcpy(out, (*w)->data(), (*w)->size());
+				out += (*w)->size();
+				*out++ = ' ';
+			}
+
+			*out++ = '\n';
+		} else {
+			put_varint(out, size_t(end - it));
+
+			for(auto w = it; w != end; w++) {
+				put_varint(out, (*w)->size());
+				memcpy(out, (*w)->data(), (*w)->size());
+				out += (*w)->size();
+			}
+		}
+
+		used = size_t(out - buffer.data());
+		it = end + 1;
+	}
+}
+
+/**
+ * This function writes the content of the buffer in the file.
+ */
+void Writer::flush() {
+	const char* data = buffer.data();
+
+	while(used > 0 && !error) {
+		ssize_t n = ::write(fd, data, used);
+
+		if(n < 0) {
+			error = true;
+		} else {
+			data += n;
+			used -= size_t(n);
+		}
+	}
+
+	used = 0;
+}
@@ -0,0 +1,115 @@
+#ifndef WRITER_HH
+#define WRITER_HH
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "anagrams.hpp"
+
+/**
+ * The 'Writer' class exports anagrams in a file.
+ *
+ * The anagrams given to the writer are gathered in batches (of pointers to
+ * their words), which are formatted and written by a separate thread. The
+ * formatting is done in a large buffer, which is written in the file with a
+ * single call to 'write' once it is full. The search of the anagrams can
+ * then go on while the previous anagrams are exported.
+ *
+ * Two formats are available :
+ * 		- TEXT : one anagram per line, each word followed by a space;
+ * 		- BINARY : the header "ANAG" followed by a version byte (2), and then
+ * 		  for each anagram, its number of words followed by each word, as its
+ * 		  length and its letters. The numbers are varints (7 bits per byte, the
+ * 		  highest bit set on all bytes but the last), i.e. a single byte below 128.
+ *
+ * The words of the anagrams must remain valid until the writer is closed.
+ */
+class Writer {
+public:
+	enum format : unsigned int {
+		TEXT,
+		BINARY
+	};
+
+	Writer(const std::string& filename, format f = TEXT);
+	~Writer();
+
+	Writer(const Writer&) = delete;
+	Writer& operator=(const Writer&) = delete;
+
+	/**
+	 * This function indicates whether the file of the writer is open.
+	 *
+	 * @return 	A Boolean value indicating whether the file is open
+	 */
+	bool is_open() const { return fd >= 0; }
+
+	/**
+	 * These functions add an anagram to the export.
+	 *
+	 * @param 	anagram The anagram to export
+	 */
+	void write(const Anagram& anagram);
+	void write(const std::vector<std::string>& anagram);
+
+	/**
+	 * This function waits until all the anagrams given so far are formatted
+	 * (their words can then be released).
+	 */
+	void wait();
+
+	/**
+	 * This function exports the remaining anagrams and closes the file. It
+	 * is called by the destructor if needed.
+	 *
+	 * @return 	A Boolean value indicating whether all the anagrams were
+	 *			written in the file
+	 */
+	bool close();
+
+private:
+	typedef std::vector<const std::string*> Batch;
+
+	/// Number of words (and end of anagrams) in a batch
+	static const size_t BATCH_SIZE = 1 << 16;
+
+	/// Maximum number of batches waiting to be written
+	static const size_t QUEUE_SIZE = 4;
+
+	/// Size of the buffer in which the anagrams are formatted
+	static const size_t BUFFER_SIZE = 1 << 20;
+
+	int fd;
+	format fmt;
+	bool error = false;
+
+	/// Batch being filled (a nullptr marks the end of an anagram)
+	Batch batch;
+
+	/// Batches waiting to be written, and batches that can be reused
+	std::deque<Batch> queue;
+	std::vector<Batch> free_batches;
+
+	std::mutex mutex;
+	std::condition_variable cond;
+	bool done = false;
+	bool busy = false;
+
+	std::thread thread;
+
+	/// Buffer of the formatted anagrams (only used by the thread)
+	std::vector<char> buffer;
+	size_t used = 0;
+
+	void push_batch();
+
+	void run();
+	void format_batch(const Batch& b);
+	void flush();
+};
+
+#endif
@@ -0,0 +1,118 @@
+/**
+ * Object-oriented programming projects - Project 1
+ * Anagram Generator
+ *
+ * This program checks the 'Store' class while it is updated : several threads
+ * take snapshots and check them (their words and their index) while another
+ * thread removes words from the dictionary and adds them back.
+ *
+ * @author Maxime Meurisse (m.meurisse@student.uliege.be) - 20161278
+ * @version 2019.05.04
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cstdlib>
+
+#include "../src/store.hpp"
+
+using namespace std;
+
+/// Number of updates, of threads taking snapshots and of words updated
+static const unsigned NB_UPDATES = 100;
+static const unsigned NB_READERS = 3;
+static const unsigned NB_WORDS = 50;
+
+/**
+ * This function checks a snapshot : the words updated are in the dictionary
+ * (and found by its index) in the even versions, and removed from it in the
+ * odd versions.
+ *
+ * @param 	snapshot The snapshot
+ * @param 	words The words updated
+ * @param 	size The number of words of the dictionary
+ * @return 	A Boolean value indicating whether the snapshot is valid
+ */
+static bool check(const Store<English>::Snapshot& snapshot, const vector<string>& words, size_t size) {
+	bool present = (snapshot.version % 2 == 0);
+	size_t nb = 0;
+
+	for(const auto& e : snapshot.dict)
+		if(!e.removed)
+			nb++;
+
+	if(nb != (present ? size : size - words.size()))
+		return false;
+
+	for(const string& w : words) {
+		vector<string> found = exact_anagrams(w, snapshot.dict, snapshot.index);
+
+		if((find(found.begin(), found.end(), w) != found.end()) != present)
+			return false;
+	}
+
+	return true;
+}
+
+int main() {
+	Store<English> store("dictionaries/sowpods.txt");
+
+	vector<string> words;
+	size_t size = store.get()->dict.size();
+
+	for(size_t i = 0; i < NB_WORDS; i++)
+		words.push_back(store.get()->dict[i * size / NB_WORDS].word);
+
+	atomic<bool> done(false);
+	atomic<unsigned> nb_checked(0), nb_failed(0);
+	vector<thread> readers;
+
+	/// Each reader keeps its snapshot while checking it, so that the updates
+	/// both reuse the previous snapshot and copy the current one
+	for(unsigned r = 0; r < NB_READERS; r++) {
+		readers.emplace_back([&]() {
+			uint64_t last = 0;
+
+			while(!done) {
+				auto snapshot = store.get();
+
+				if(snapshot->version < last || !check(*snapshot, words, size))
+					nb_failed++;
+
+				last = snapshot->version;
+				nb_checked++;
+			}
+		});
+	}
+
+	for(unsigned u = 0; u < NB_UPDATES; u++) {
+		size_t nb = (u % 2 == 0) ? store.update({}, words) : store.update(words, {});
+
+		if(nb != words.size())
+			nb_failed++;
+	}
+
+	done = true;
+
+	for(thread& reader : readers)
+		reader.join();
+
+	if(store.get()->version != NB_UPDATES || !check(*store.get(), words, size))
+		nb_failed++;
+
+	cout << "Snapshots checked : " << nb_checked << endl;
+
+	if(nb_failed > 0) {
+		cerr << "Store : " << nb_failed << " check(s) failed." << endl;
+
+		return EXIT_FAILURE;
+	}
+
+	cout << "Store : OK" << endl;
+
+	return EXIT_SUCCESS;
+}
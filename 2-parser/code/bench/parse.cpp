@@ -0,0 +1,151 @@
+/**
+ * Object-oriented programming projects - Project 2
+ * Parsing a painting language
+ *
+ * This file is the benchmark of the parser : it measures the throughput
+ * (tokens and instructions per second) and the peak memory of the parsing of paint files.
+ * The paint files are generated by the generator of project 3 (cfr. 'make bench').
+ *
+ * Each file is measured by a child process, so that the peak memory
+ * of a file doesn't depend on the files measured before it.
+ *
+ * @author Maxime Meurisse (m.meurisse@student.uliege.be) - 20161278
+ * @version 2019.05.04
+ */
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../src/parser.hpp"
+
+using namespace std;
+
+/**
+ * This function is used to get the peak memory (resident set size) of the process.
+ *
+ * @return the peak memory, in MiB
+ */
+double peak_memory() {
+	struct rusage usage;
+
+	getrusage(RUSAGE_SELF, &usage);
+
+	return double(usage.ru_maxrss) / 1024;
+}
+
+/**
+ * This function is used to count the tokens of a paint file (the "END" token excluded).
+ *
+ * @param filename the paint file
+ * @param size the size of the file
+ *
+ * @return the number of tokens
+ */
+size_t count_tokens(const string& filename, size_t& size) {
+	Lexer lexer;
+	vector<token> block(TokenStream::BLOCK_SIZE);
+	size_t count = 0, n;
+
+	lexer.open(filename);
+	size = lexer.get_size();
+
+	while((n = lexer.read(block.data(), block.size())) > 0)
+		for(size_t i = 0; i < n; i++)
+			count += (block[i].type != END);
+
+	return count;
+}
+
+/**
+ * This function is used to measure the parsing of a paint file and to print the results.
+ *
+ * @param filename the paint file
+ * @param rounds the number of parsings (the fastest one is kept)
+ *
+ * @return a boolean value indicating if the file is valid
+ */
+bool measure(const string& filename, int rounds) {
+	double before = peak_memory(), best = 0;
+	size_t statements = 0;
+
+	for(int r = 0; r < rounds; r++) {
+		Parser parser(filename);
+
+		auto start = chrono::steady_clock::now();
+		bool valid = parser.parse_file();
+		auto end = chrono::steady_clock::now();
+
+		if(!valid) {
+			cerr << parser.get_error() << endl;
+
+			return false;
+		}
+
+		double time = chrono::duration <double, milli> (end - start).count();
+
+		if(r == 0 || time < best)
+			best = time;
+
+		/// Each instruction defines a shape or a color, or fills a shape (and the size is the first one).
+		statements = 1 + parser.get_nb_shapes() + parser.get_nb_colors() + parser.get_nb_fills();
+	}
+
+	double peak = peak_memory();
+	size_t size;
+	size_t tokens = count_tokens(filename, size);
+	double seconds = best / 1000;
+
+	cout << filename << " : " << statements << " statements, " << tokens << " tokens, " << double(size) / (1 << 20) << " MiB" << endl;
+	cout << "\tparsing : " << best << " ms (best of " << rounds << ")" << endl;
+	cout << "\tthroughput : " << statements / seconds / 1e6 << " M statements/s, " << tokens / seconds / 1e6 << " M tokens/s, " << double(size) / (1 << 20) / seconds << " MiB/s" << endl;
+	cout << "\tpeak memory : " << peak << " MiB (" << before << " MiB before parsing)" << endl;
+
+	return true;
+}
+
+int main(int argc, char* argv[]) {
+	vector<string> files;
+	int rounds = 3;
+
+	/// Retrieving options and files.
+	for(int i = 1; i < argc; i++) {
+		string arg = argv[i];
+
+		if(arg == "-r" && i + 1 < argc && atoi(argv[i + 1]) > 0)
+			rounds = atoi(argv[++i]);
+		else
+			files.push_back(arg);
+	}
+
+	if(files.empty()) {
+		cerr << "Usage : " << argv[0] << " [-r ROUNDS] INPUT_FILE..." << endl;
+
+		return 1;
+	}
+
+	bool valid = true;
+
+	for(const string& filename : files) {
+		pid_t pid = fork();
+		int status;
+
+		if(pid == 0) {
+			bool ok = measure(filename, rounds);
+
+			cout.flush();
+			_exit(ok ? 0 : 1);
+		}
+
+		if(pid < 0 || waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+			valid = false;
+	}
+
+	return valid ? 0 : 1;
+}
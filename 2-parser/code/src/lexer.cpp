@@ -0,0 +1,474 @@
+/**
+ * Object-oriented programming projects - Project 2
+ * Parsing a painting language
+ *
+ * This file is the implementation of the 'Lexer' and 'TokenStream' classes.
+ *
+ * @author Maxime Meurisse (m.meurisse@student.uliege.be) - 20161278
+ * @version 2019.05.04
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <cstdint>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "lexer.hpp"
+#include "../../../common/paint_chars.hpp"
+
+using namespace std;
+
+/// Classes of the chars of a paint file (cfr. 'make_classes'), without strings.
+static const CharClasses CHAR_CLASSES = make_classes(false);
+
+/*********/
+/* Lexer */
+/*********/
+
+Lexer::~Lexer() {
+	if(mapped)
+		munmap(const_cast<char*>(data), data_size);
+}
+
+bool Lexer::open(const string& filename) {
+	struct stat st;
+	int fd = ::open(filename.c_str(), O_RDONLY);
+
+	if(fd < 0)
+		return false;
+
+	if(fstat(fd, &st) < 0) {
+		close(fd);
+
+		return false;
+	}
+
+	data_size = size_t(st.st_size);
+
+	/// An empty file can't be mapped (but has no content anyway).
+	if(data_size > 0) {
+		void* m = mmap(nullptr, data_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+		if(m == MAP_FAILED) {
+			close(fd);
+
+			return false;
+		}
+
+		madvise(m, data_size, MADV_SEQUENTIAL);
+
+		data = static_cast<const char*>(m);
+		mapped = true;
+	}
+
+	close(fd);
+
+	return true;
+}
+
+size_t Lexer::read(token* o, size_t max) {
+	out = o;
+	out_count = 0;
+
+	/// A step produces at most 3 tokens.
+	while(!finished && !error && out_count + 3 <= max)
+		step();
+
+	return out_count;
+}
+
+string Lexer::get_content(const token& t) const {
+	if(t.type == END)
+		return "END";
+
+	return string(data + t.offset, t.length);
+}
+
+/**
+ * This method is used to convert the next char of the file (or to go to the next line).
+ */
+void Lexer::step() {
+	/// Beginning of a line, or end of the file.
+	if(!in_line) {
+		flush();
+
+		if(error)
+			return;
+
+		if(pos < data_size) {
+			const char* eol = static_cast<const char*>(memchr(data + pos, '\n', data_size - pos));
+
+			line_end = eol ? size_t(eol - data) : data_size;
+			line++;
+			col = 0;
+			in_line = true;
+		} else {
+			token end = {++line, 0, END, 0, 0};
+
+			out[out_count++] = end;
+			finished = true;
+		}
+
+		return;
+	}
+
+	if(pos >= line_end) {
+		pos = line_end + 1;
+		in_line = false;
+
+		return;
+	}
+
+	size_t i = pos++;
+	char c = data[i];
+
+	col++;
+
+	unsigned char c_class = CHAR_CLASSES[uint8_t(c)];
+
+	if(c_class == C_SPACE || c_class == C_COMMENT || c_class == C_SPECIAL) {
+		flush();
+
+		if(error)
+			return;
+
+		if(c == '#') {
+			pos = line_end;
+		} else if(c != char(32)) {
+			begin = i;
+			length = 1;
+
+			switch(c) {
+				case '{': push_token(OPEN_BRACE); break;
+				case '}': push_token(CLOSE_BRACE); break;
+				case '(': push_token(OPEN_PAR); break;
+				case ')': push_token(CLOSE_PAR); break;
+				case '*':
+				case '/': push_token(OPERATOR); break;
+			}
+		}
+	} else if(c_class == C_POINT) {
+		token t;
+
+		if(!create_token(line, col, t))
+			return;
+
+		if(t.type == STRING) {
+			push_token(t);
+
+			begin = i;
+			length = 1;
+			push_token(POINT);
+		} else if(t.type == NUMBER) {
+			append(i);
+		} else {
+			context |= (last_type == END);
+
+			if(last_type == CLOSE_BRACE || last_type == CLOSE_PAR) {
+				begin = i;
+				length = 1;
+				push_token(POINT);
+			} else {
+				append(i);
+			}
+		}
+	} else if((c == 'x' || c == 'y') && length > 0 && data[begin + length - 1] == '.') {
+		push_token(POINT);
+		append(i);
+		flush();
+	} else {
+		/// The next chars of the run (names and numbers) are added at once.
+		append(i);
+
+		size_t end = scan_run(CHAR_CLASSES, data, pos, line_end, classes, nb_signs);
+
+		col += unsigned(end - pos);
+		length += end - pos;
+		pos = end;
+	}
+}
+
+/**
+ * This method is used to create a token from the buffer by determining its type based on its content.
+ * If the content is not valid, the error is kept and the conversion stops.
+ *
+ * @param line the line of the token
+ * @param col the col of the token
+ * @param t the created token (whose type is 'END' if the buffer is empty)
+ *
+ * @return a boolean value indicating if the content of the token is valid
+ */
+bool Lexer::create_token(const unsigned int line, const unsigned int col, token& t) {
+	t = {line, col - unsigned(length), END, begin, length};
+
+	if(length > 0) {
+		const char* content = data + begin;
+
+		/// The type is given by the classes of the chars of the buffer (cfr. 'append').
+		if(length == 1 && nb_signs == 1) {
+			t.type = OPERATOR;
+		} else if((classes & ~(C_DIGIT | C_POINT | C_SIGN)) == 0 && (classes & C_DIGIT) && nb_points <= 1 && nb_signs <= 1) {
+			if(nb_signs == 0) {
+				t.type = NUMBER;
+			} else if(content[0] == '+' || content[0] == '-') {
+				t.type = NUMBER;
+			} else {
+				error_message = "misplaced operator ('" + string(content, length) + "').";
+				error = true;
+			}
+		} else if((classes & ~(C_NAME | C_DIGIT)) == 0 && is_letter(content[0])) {
+			t.type = STRING;
+		} else {
+			error_message = "invalid element ('" + string(content, length) + "').";
+			error = true;
+		}
+	}
+
+	if(error)
+		error_token = t;
+
+	return !error;
+}
+
+/**
+ * This method is used to produce a token. It also flushes the buffer.
+ *
+ * @param t the token to produce
+ */
+void Lexer::push_token(const token& t) {
+	out[out_count++] = t;
+	last_type = t.type;
+	length = 0;
+}
+
+/**
+ * This method is used to produce a token of a given type from the buffer.
+ *
+ * @param type the type of the token
+ */
+void Lexer::push_token(const unsigned int type) {
+	token t = {line, col - unsigned(length), type, begin, length};
+
+	push_token(t);
+}
+
+/**
+ * This method is used to produce the token of the buffer (if it is not empty).
+ */
+void Lexer::flush() {
+	token t;
+
+	if(length > 0 && create_token(line, col, t))
+		push_token(t);
+}
+
+/**
+ * This method is used to add the char at position 'i' to the buffer.
+ *
+ * @param i the position of the char in the file
+ */
+void Lexer::append(size_t i) {
+	unsigned char c_class = CHAR_CLASSES[uint8_t(data[i])];
+
+	if(length == 0) {
+		begin = i;
+		classes = 0;
+		nb_signs = nb_points = 0;
+	}
+
+	length++;
+	classes |= c_class;
+	nb_signs += (c_class == C_SIGN);
+	nb_points += (c_class == C_POINT);
+}
+
+/***************/
+/* TokenStream */
+/***************/
+
+TokenStream::~TokenStream() {
+	{
+		lock_guard<std::mutex> lock(mutex);
+
+		stop = true;
+	}
+
+	not_full.notify_all();
+
+	for(thread& worker : workers)
+		worker.join();
+}
+
+void TokenStream::start(unsigned int threads) {
+	threaded = threads > 0;
+	started = true;
+
+	if(threaded) {
+		nb_parts = (lexer.data_size + PART_SIZE - 1) / PART_SIZE;
+		max_parts = max(size_t(QUEUE_SIZE), 2 * size_t(threads));
+
+		for(unsigned int i = 0; i < threads; i++)
+			workers.emplace_back(&TokenStream::produce, this);
+	}
+}
+
+bool TokenStream::fill(vector<token>& block) {
+	if(!started)
+		return false;
+
+	if(!threaded) {
+		block.resize(BLOCK_SIZE);
+		block.resize(lexer.read(block.data(), BLOCK_SIZE));
+
+		return !block.empty();
+	}
+
+	while(!finished) {
+		unique_lock<std::mutex> lock(mutex);
+
+		/// The last token of the file.
+		if(first_part == nb_parts) {
+			token end = {lexer.line + nb_lines + 1, 0, END, 0, 0};
+
+			block.assign(1, end);
+			finished = true;
+
+			return true;
+		}
+
+		not_empty.wait(lock, [this] { return !parts.empty() && parts.front().done; });
+
+		Part part = move(parts.front());
+
+		parts.pop_front();
+		first_part++;
+
+		lock.unlock();
+		not_full.notify_all();
+
+		if(part.context && (last_type == CLOSE_BRACE || last_type == CLOSE_PAR))
+			convert(part, last_type);
+
+		for(token& t : part.tokens)
+			t.line += lexer.line + nb_lines;
+
+		if(part.error) {
+			lexer.error = true;
+			lexer.error_token = part.error_token;
+			lexer.error_token.line += lexer.line + nb_lines;
+			lexer.error_message = part.error_message;
+
+			finished = true;
+		}
+
+		if(!part.tokens.empty())
+			last_type = part.last_type;
+
+		nb_lines += part.nb_lines;
+
+		if(!part.tokens.empty()) {
+			block = move(part.tokens);
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void TokenStream::drain() {
+	vector<token> block;
+
+	while(fill(block));
+}
+
+/**
+ * This method is used to get the beginning of the part 'k' of the file
+ * (the beginning of the first line after the position 'k' * 'PART_SIZE').
+ *
+ * @param k the index of the part
+ *
+ * @return the position of the beginning of the part
+ */
+size_t TokenStream::part_begin(size_t k) const {
+	size_t pos = k * PART_SIZE;
+
+	if(pos == 0 || pos >= lexer.data_size || lexer.data[pos - 1] == '\n')
+		return min(pos, lexer.data_size);
+
+	const char* eol = static_cast<const char*>(memchr(lexer.data + pos, '\n', lexer.data_size - pos));
+
+	return eol ? size_t(eol - lexer.data) + 1 : lexer.data_size;
+}
+
+/**
+ * This method is used to convert a part of the file into tokens.
+ *
+ * @param part the part to convert
+ * @param last the type of the token before the part
+ */
+void TokenStream::convert(Part& part, unsigned int last) const {
+	Lexer l;
+	size_t n = 0, count;
+
+	/// The lexer only sees the lines of the part.
+	l.data = lexer.data;
+	l.data_size = part.end;
+	l.pos = part.begin;
+	l.last_type = last;
+
+	do {
+		part.tokens.resize(n + BLOCK_SIZE);
+		count = l.read(part.tokens.data() + n, BLOCK_SIZE);
+		n += count;
+	} while(count > 0);
+
+	part.tokens.resize(n);
+
+	part.error = l.error;
+	part.error_token = l.error_token;
+	part.error_message = l.error_message;
+
+	/// The line of the "END" token follows the last line of the part.
+	if(!part.error) {
+		part.nb_lines = part.tokens.back().line - 1;
+		part.tokens.pop_back();
+	}
+
+	part.last_type = l.last_type;
+	part.context = l.context;
+}
+
+/**
+ * This method is used to convert the parts of the file (in another thread).
+ */
+void TokenStream::produce() {
+	while(true) {
+		unique_lock<std::mutex> lock(mutex);
+
+		not_full.wait(lock, [this] { return stop || next_part == nb_parts || next_part < first_part + max_parts; });
+
+		if(stop || next_part == nb_parts)
+			return;
+
+		parts.emplace_back();
+
+		Part& part = parts.back();
+
+		part.begin = part_begin(next_part);
+		part.end = part_begin(++next_part);
+
+		lock.unlock();
+
+		convert(part, END);
+
+		lock.lock();
+		part.done = true;
+		not_empty.notify_one();
+	}
+}
@@ -6,47 +6,242 @@
  * It reads the user's entries and creates the parser.
  * The parser parse the file and displays its statistics if no error has occurred.
  *
+ * Several files (or directories of files) can also be given : they are then
+ * parsed at the same time and their results are displayed in the order of the entries.
+ *
  * @author Maxime Meurisse (m.meurisse@student.uliege.be) - 20161278
  * @version 2019.05.04
  */
 
 #include <string>
+#include <vector>
 #include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdlib>
+
+#include <sys/stat.h>
+#include <dirent.h>
 
 #include "parser.hpp"
 
 using namespace std;
 
+const string VALID_EXT = ".paint";
+
+/**
+ * The result of the parsing of a file : its statistics if it is valid,
+ * its error otherwise.
+ */
+struct result {
+	bool done = false, valid = false;
+	string output;
+};
+
+/**
+ * This function is used to check if a file has the extension of the paint files.
+ *
+ * @param filename the name of the file
+ *
+ * @return a boolean value indicating if the extension of the file is valid
+ */
+bool has_valid_ext(const string& filename) {
+	return filename.size() >= VALID_EXT.size() && filename.compare(filename.size() - VALID_EXT.size(), VALID_EXT.size(), VALID_EXT) == 0;
+}
+
+/**
+ * This function is used to check if a path is a directory.
+ *
+ * @param path the path
+ *
+ * @return a boolean value indicating if the path is a directory
+ */
+bool is_directory(const string& path) {
+	struct stat st;
+
+	return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+/**
+ * This function is used to add the paint files of a directory (sorted by name) to a list of files.
+ *
+ * @param dir the directory
+ * @param files the list of files
+ *
+ * @return a boolean value indicating if the directory could be read
+ */
+bool list_directory(const string& dir, vector<string>& files) {
+	DIR* d = opendir(dir.c_str());
+
+	if(!d)
+		return false;
+
+	vector<string> names;
+
+	while(struct dirent* e = readdir(d)) {
+		string name = e->d_name;
+
+		if(has_valid_ext(name))
+			names.push_back(name);
+	}
+
+	closedir(d);
+
+	sort(names.begin(), names.end());
+
+	for(const string& name : names)
+		files.push_back(dir + (dir.back() == '/' ? "" : "/") + name);
+
+	return true;
+}
+
+/**
+ * This function is used to parse a file.
+ *
+ * @param filename the file to parse
+ * @param r the result of the parsing
+ */
+void check_file(const string& filename, result& r) {
+	ostringstream out;
+
+	if(!has_valid_ext(filename)) {
+		out << filename << ": error: extension of the input file must be '" << VALID_EXT << "'.";
+	} else {
+		/// The files are already parsed at the same time, so the parser doesn't use other threads.
+		Parser parser(filename);
+
+		r.valid = parser.parse_file(false);
+
+		if(r.valid) {
+			out << filename << endl;
+			parser.print_stats(out);
+		} else if(parser.get_error().compare(0, filename.size() + 1, filename + ":") == 0) {
+			out << parser.get_error();
+		} else {
+			out << filename << ": error: " << parser.get_error();
+		}
+	}
+
+	r.output = out.str();
+}
+
 int main(int argc, char* argv[]) {
-	const string VALID_EXT = ".paint";
+	vector<string> entries, files;
+	unsigned int threads = max(thread::hardware_concurrency(), 1u);
+	bool batch = false;
+
+	/// Retrieving options and entries.
+	for(int i = 1; i < argc; i++) {
+		string arg = argv[i];
 
-	string filename, extension;
+		if(arg == "-j" && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+			threads = unsigned(atoi(argv[++i]));
+			batch = true;
+		} else {
+			entries.push_back(arg);
+		}
+	}
 
-	/// We check that the user has only given one argument.
-	if(argc < 2 || argc > 2) {
-		cerr << "Usage : " << argv[0] << " INPUT_FILE" << endl;
+	if(entries.empty()) {
+		cerr << "Usage : " << argv[0] << " [-j THREADS] INPUT_FILE|DIRECTORY..." << endl;
 
 		return 1;
 	}
 
-	filename = argv[1];
-	extension = filename.substr(filename.length() - VALID_EXT.size(), VALID_EXT.size());
+	/// A single file is checked as usual.
+	if(!batch && entries.size() == 1 && !is_directory(entries[0])) {
+		const string& filename = entries[0];
 
-	/// We check that the extension of the file is valid.
-	if(extension != VALID_EXT) {
-		cerr << "Extension of the input file must be '" << VALID_EXT << "'." << endl;
+		/// We check that the extension of the file is valid.
+		if(!has_valid_ext(filename)) {
+			cerr << "Extension of the input file must be '" << VALID_EXT << "'." << endl;
 
-		return 1;
+			return 1;
+		}
+
+		/// We instantiate a parser.
+		Parser parser(filename);
+
+		/// We parse the file.
+		if(!parser.parse_file()) {
+			cerr << parser.get_error() << endl;
+
+			return 1;
+		}
+
+		/// If there were no errors, the statistics of the parse are displayed.
+		parser.print_stats();
+
+		return 0;
 	}
 
-	/// We instantiate a parser.
-	Parser parser(filename);
+	/// The directories are replaced by their paint files.
+	for(const string& entry : entries) {
+		if(!is_directory(entry)) {
+			files.push_back(entry);
+		} else if(!list_directory(entry, files)) {
+			cerr << "Unable to read directory '" << entry << "'." << endl;
+
+			return 1;
+		}
+	}
+
+	/// The files are parsed by a pool of threads, each one taking the next file to parse,
+	/// while the results are displayed (in the order of the files) as soon as they are known.
+	vector<result> results(files.size());
+	atomic<size_t> next(0);
+	mutex m;
+	condition_variable finished;
+	vector<thread> pool;
+
+	threads = unsigned(min(size_t(threads), files.size()));
+
+	for(unsigned int i = 0; i < threads; i++) {
+		pool.emplace_back([&files, &results, &next, &m, &finished] {
+			for(size_t f = next++; f < files.size(); f = next++) {
+				result r;
+
+				check_file(files[f], r);
+				r.done = true;
+
+				{
+					lock_guard<mutex> lock(m);
+
+					results[f] = move(r);
+				}
+
+				finished.notify_one();
+			}
+		});
+	}
+
+	size_t nb_valid = 0;
+
+	for(size_t f = 0; f < files.size(); f++) {
+		unique_lock<mutex> lock(m);
+
+		finished.wait(lock, [&results, f] { return results[f].done; });
+		lock.unlock();
+
+		const result& r = results[f];
+
+		if(r.valid) {
+			nb_valid++;
+			cout << r.output << endl;
+		} else {
+			cerr << r.output << endl << endl;
+		}
+	}
 
-	/// We parse the file.
-	parser.parse_file();
+	for(thread& t : pool)
+		t.join();
 
-	/// If there were no errors, the statistics of the parse are displayed.
-	parser.print_stats();
+	/// Summary of the check.
+	cout << "Number of files: " << files.size() << " (" << nb_valid << " valid, " << files.size() - nb_valid << " invalid)" << endl;
 
-	return 0;
+	return nb_valid == files.size() ? 0 : 1;
 }
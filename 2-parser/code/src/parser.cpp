@@ -8,9 +8,7 @@
  * @version 2019.05.04
  */
 
-#include <fstream>
 #include <iostream>
-#include <cstdlib>
 
 #include "parser.hpp"
 
@@ -21,220 +19,82 @@ using namespace std;
 /******************/
 
 Parser::Parser(const string fname) {
-	if(fname.empty())
-		print_error("Filename is empty.");
-
 	Parser::filename = fname;
 }
 
-void Parser::parse_file() {
-	convert_token();
+bool Parser::parse_file(const bool threaded) {
+	try {
+		if(filename.empty())
+			raise_error("Filename is empty.");
+
+		if(!lexer.open(filename))
+			raise_error("Unable to open file.");
+
+		/// The parts of large files are converted by the other cores.
+		unsigned int cores = thread::hardware_concurrency();
+
+		stream.start(threaded && lexer.get_size() >= THREADED_SIZE && cores > 1 ? cores - 1 : 0);
+
+		parse_size();
+		parse_instr();
+	} catch(const ParseError& e) {
+		error = e.what();
 
-	parse_size();
-	parse_instr();
+		return false;
+	}
+
+	return true;
 }
 
-void Parser::print_stats() const {
-	cout << "Number of shapes: " << shapes.size() << endl;
-	cout << "Number of colors: " << colors.size() << endl;
-	cout << "Number of fills: " << fills.size() << endl;
+void Parser::print_stats(ostream& out) const {
+	out << "Number of shapes: " << shapes.size() << endl;
+	out << "Number of colors: " << colors.size() << endl;
+	out << "Number of fills: " << nb_fills << endl;
 }
 
 /*******************/
 /* Private methods */
 /*******************/
 
-/****************************/
-/* Token conversion methods */
-/****************************/
+/************************/
+/* Token access methods */
+/************************/
 
 /**
- * This method is used to create a token by determining its type based on its content.
+ * This method is used to return the next token of the file.
+ * Depending on the value of 'incr', the next token that will be return at next call is the same or the next.
  *
- * @param line the line of the token
- * @param col the col of the token
- * @param content the content of the token
- * @param file the file to close if an error occured
+ * @param incr an increment value that determines the next token that will be return at next call
  *
- * @return a token whose type has been determined according to its content
+ * @return the next token of the file
  */
-token Parser::create_token(const unsigned int line, const unsigned int col, const string content, ifstream& file) const {
-	unsigned int nb_char = 0, nb_digit = 0, nb_point = 0, nb_operator = 0;
-	unsigned int content_length = content.length();
-	token t = {line, col - content_length, 0, content};
-
-	if(!content.empty()) {
-		for(char c : content)
-			if(isalpha(c) || c == '_')
-				nb_char++;
-			else if(isdigit(c))
-				nb_digit++;
-			else if(c == '.')
-				nb_point++;
-			else if(c == '+' || c == '-')
-				nb_operator++;
-
-		if(nb_operator == content_length && nb_operator == 1) {
-			t.type = OPERATOR;
-		} else if(nb_digit + nb_point + nb_operator == content_length && nb_point <= 1 && nb_operator <= 1 && nb_digit >= 1) {
-			if(nb_operator == 0) {
-				t.type = NUMBER;
-			} else if(nb_operator == 1 && (content.at(0) == '+' || content.at(0) == '-')) {
-				t.type = NUMBER;
-			} else {
-				file.close();
-
-				print_error(t, "misplaced operator ('" + t.content + "').");
-			}
-		} else if(nb_char + nb_digit == content_length && isalpha(content.at(0))) {
-			t.type = STRING;
-		} else {
-			file.close();
+token Parser::next_token(const int& incr = 1) {
+	if(block_pos >= block.size()) {
+		if(!stream.fill(block)) {
+			if(lexer.failed())
+				raise_lexer_error();
 
-			print_error(t, "invalid element ('" + t.content + "').");
+			raise_error("Out of file.");
 		}
-	}
-
-	return t;
-}
-
-/**
- * This method is used to create a token.
- *
- * @param line the line of the token
- * @param col the col of the token
- * @param type the type of the token
- * @param content the content of the token
- *
- * @return the created token
- */
-token Parser::create_token(const unsigned int line, const unsigned int col, const unsigned int type, const string content) const {
-	token t = {line, unsigned(col - content.length()), type, content};
 
-	return t;
-}
-
-/**
- * This method is used to push the token in the 'file_content' vector.
- * It also flushes the buffer.
- * If the buffer is empty, it means that the token is empty too (no content, unknown type), so we don't push.
- *
- * @param t the token to push
- * @param buffer the buffer containing the content of the token
- */
-void Parser::push_token(const token t, string& buffer) {
-	if(!buffer.empty()) {
-		file_content.push_back(t);
-		buffer.clear();
+		block_pos = 0;
 	}
-}
-
-/**
- * This method is used to convert the content of the file 'filename' to tokens and store it in 'file_content'.
- */
-void Parser::convert_token() {
-	unsigned int line = 0, col = 0;
-	string line_content, buffer;
-	ifstream file;
 
-	file.open(filename);
+	token t = block[block_pos];
+	block_pos += incr;
 
-	if(!file)
-		print_error("Unable to open file.");
-
-	while(getline(file, line_content)) {
-		push_token(create_token(line, col, buffer, file), buffer);
-
-		line++;
-		col = 0;
-
-		for(char c : line_content) {
-			col++;
-
-			if(is_in(SPECIAL_CHARS, c)) {
-				push_token(create_token(line, col, buffer, file), buffer);
-
-				if(c == '#') {
-					break;
-				} else if(c == char(32)) {
-					continue;
-				} else {
-					buffer = c;
-
-					switch(c) {
-						case '{': push_token(create_token(line, col, OPEN_BRACE, buffer), buffer); break;
-						case '}': push_token(create_token(line, col, CLOSE_BRACE, buffer), buffer); break;
-						case '(': push_token(create_token(line, col, OPEN_PAR, buffer), buffer); break;
-						case ')': push_token(create_token(line, col, CLOSE_PAR, buffer), buffer); break;
-						case '*':
-						case '/': push_token(create_token(line, col, OPERATOR, buffer), buffer); break;
-					}
-				}
-			} else if(c == '.') {
-				token t = create_token(line, col, buffer, file);
-
-				if(t.type == STRING) {
-					push_token(t, buffer);
-
-					buffer = c;
-					push_token(create_token(line, col, POINT, buffer), buffer);
-				} else if(t.type == NUMBER) {
-					buffer += c;
-				} else {
-					if(!file_content.empty()) {
-						token back = file_content.back();
-
-						if(back.type == CLOSE_BRACE || back.type == CLOSE_PAR) {
-							buffer = c;
-							push_token(create_token(line, col, POINT, buffer), buffer);
-						} else {
-							buffer += c;
-						}
-					} else {
-						buffer += c;
-					}
-				}
-			} else if(is_in(SPECIAL_POINTS, c)) {
-				if(buffer.back() == '.') {
-					push_token(create_token(line, col, POINT, buffer), buffer);
-
-					buffer = c;
-					push_token(create_token(line, col, buffer, file), buffer);
-				} else {
-					buffer += c;
-				}
-			} else {
-				buffer += c;
-			}
-		}
-	}
-
-	push_token(create_token(line, col, buffer, file), buffer);
-
-	buffer = "END";
-	push_token(create_token(++line, buffer.length(), END, buffer), buffer);
-
-	file_content_size = file_content.size();
-
-	file.close();
+	return t;
 }
 
 /**
- * This method is used to return a token of the 'file_content' vector.
- * Depending on the value of 'incr', the next token that will be return at next call is the same or the next.
+ * This method is used to get the content of a token.
  *
- * @param incr an increment value that determines the next token that will be return at next call
+ * @param t the token
  *
- * @return a token of the 'file_content' vector
+ * @return the content of the token
  */
-token Parser::next_token(const int& incr = 1) {
-	if(file_content_pos >= file_content_size)
-		print_error("Out of file.");
-
-	token t = file_content.at(file_content_pos);
-	file_content_pos += incr;
-
-	return t;
+string Parser::get_content(const token& t) const {
+	return lexer.get_content(t);
 }
 
 /*******************/
@@ -251,10 +111,10 @@ void Parser::parse_instr() {
 	token keyword = next_token();
 
 	while(keyword.type != END) {
-		string content = keyword.content;
+		string content = get_content(keyword);
 
 		if(keyword.type != STRING)
-			print_error(keyword, "invalid keyword format ('" + keyword.content + "').");
+			raise_error(keyword, "invalid keyword format ('" + get_content(keyword) + "').");
 
 		if(content == "circ")
 			parse_circ();
@@ -275,9 +135,9 @@ void Parser::parse_instr() {
 		else if(content == "fill")
 			parse_fill();
 		else
-			print_error(keyword, "unknown keyword ('" + content + "').");
+			raise_error(keyword, "unknown keyword ('" + content + "').");
 
-		token keyword = next_token();
+		keyword = next_token();
 	}
 }
 
@@ -288,8 +148,8 @@ void Parser::parse_instr() {
 void Parser::parse_size() {
 	token keyword = next_token();
 
-	if(keyword.content != "size")
-		print_error(keyword, "expected 'size' keyword (got '" + keyword.content + "').");
+	if(get_content(keyword) != "size")
+		raise_error(keyword, "expected 'size' keyword (got '" + get_content(keyword) + "').");
 
 	parse_number();
 	parse_number();
@@ -358,7 +218,7 @@ void Parser::parse_union() {
 	token t = next_token();
 
 	if(t.type != OPEN_BRACE)
-		print_error(t, "expected '{' (got '" + t.content + "').");
+		raise_error(t, "expected '{' (got '" + get_content(t) + "').");
 
 	parse_name(CHECK_SHAPE);
 
@@ -368,7 +228,7 @@ void Parser::parse_union() {
 	t = next_token();
 
 	if(t.type != CLOSE_BRACE)
-		print_error(t, "expected '}' (got '" + t.content + "')");
+		raise_error(t, "expected '}' (got '" + get_content(t) + "')");
 }
 
 /**
@@ -398,12 +258,12 @@ void Parser::parse_color_def() {
 			t = next_token();
 
 			if(t.type != CLOSE_BRACE)
-				print_error(t, "expected '}' (got '" + t.content + "').");
+				raise_error(t, "expected '}' (got '" + get_content(t) + "').");
 
 			break;
 
 		case STRING: parse_name(CHECK_COLOR); break;
-		default: print_error(t, "expected '{' or a color name (got '" + t.content + "').");
+		default: raise_error(t, "expected '{' or a color name (got '" + get_content(t) + "').");
 	}
 }
 
@@ -434,49 +294,50 @@ void Parser::parse_fill() {
  */
 void Parser::parse_name(const unsigned int& parse_name_type) {
 	token name = next_token();
-	token exist;
 
 	if(name.type != STRING)
-		print_error(name, "expected string type for name (got '" + name.content + "').");
+		raise_error(name, "expected string type for name (got '" + get_content(name) + "').");
 
 	switch(parse_name_type) {
-		case NEW_SHAPE:
-			if(is_in(shapes, name, exist))
-				print_error(name, "shape '" + name.content + "' already defined at " + to_string(exist.line) + ":" + to_string(exist.col) + ".");
-			else
-				shapes.push_back(name);
+		case NEW_SHAPE: {
+			auto exist = shapes.emplace(get_content(name), definition{name.line, name.col});
+
+			if(!exist.second)
+				raise_error(name, "shape '" + get_content(name) + "' already defined at " + to_string(exist.first->second.line) + ":" + to_string(exist.first->second.col) + ".");
 
 			break;
+		}
 
-		case NEW_COLOR:
-			if(is_in(colors, name, exist))
-				print_error(name, "color '" + name.content + "' already defined at " + to_string(exist.line) + ":" + to_string(exist.col) + ".");
-			else
-				colors.push_back(name);
+		case NEW_COLOR: {
+			auto exist = colors.emplace(get_content(name), definition{name.line, name.col});
+
+			if(!exist.second)
+				raise_error(name, "color '" + get_content(name) + "' already defined at " + to_string(exist.first->second.line) + ":" + to_string(exist.first->second.col) + ".");
 
 			break;
+		}
 
 		case NEW_FILL:
-			if(!is_in(shapes, name, exist))
-				print_error(name, "shape '" + name.content + "' doesn't exist.");
+			if(shapes.find(get_content(name)) == shapes.end())
+				raise_error(name, "shape '" + get_content(name) + "' doesn't exist.");
 			else
-				fills.push_back(name);
+				nb_fills++;
 
 			break;
 
 		case CHECK_SHAPE:
-			if(!is_in(shapes, name, exist))
-				print_error(name, "shape '" + name.content + "' doesn't exist.");
+			if(shapes.find(get_content(name)) == shapes.end())
+				raise_error(name, "shape '" + get_content(name) + "' doesn't exist.");
 
 			break;
 
 		case CHECK_COLOR:
-			if(!is_in(colors, name, exist))
-				print_error(name, "color '" + name.content + "' doesn't exist.");
+			if(colors.find(get_content(name)) == colors.end())
+				raise_error(name, "color '" + get_content(name) + "' doesn't exist.");
 
 			break;
 
-		default: print_error("parse_name : unknown operation.");
+		default: raise_error("parse_name : unknown operation.");
 	}
 }
 
@@ -492,12 +353,12 @@ void Parser::parse_number() {
 		t = next_token();
 
 		if(t.type != POINT)
-			print_error(t, "expected '.' (got '" + t.content + "').");
+			raise_error(t, "expected '.' (got '" + get_content(t) + "').");
 
 		t = next_token();
 
-		if(!is_in(SPECIAL_POINTS, t.content.at(0)))
-			print_error(t, "'" + t.content + "' is not a valid coordinate.");
+		if(!is_in(SPECIAL_POINTS, get_content(t).at(0)))
+			raise_error(t, "'" + get_content(t) + "' is not a valid coordinate.");
 	} else {
 		t = next_token();
 	}
@@ -519,7 +380,7 @@ void Parser::parse_point() {
 			t = next_token();
 
 			if(t.type != CLOSE_BRACE)
-				print_error(t, "expected '}' (got '" + t.content + "').");
+				raise_error(t, "expected '}' (got '" + get_content(t) + "').");
 
 			break;
 
@@ -529,12 +390,12 @@ void Parser::parse_point() {
 			t = next_token();
 
 			if(t.type != POINT)
-				print_error(t, "expected '.' (got '" + t.content + "').");
+				raise_error(t, "expected '.' (got '" + get_content(t) + "').");
 
 			t = next_token();
 
 			if(t.type != STRING)
-				print_error(t, "expected a point name (got '" + t.content + "').");
+				raise_error(t, "expected a point name (got '" + get_content(t) + "').");
 
 			break;
 
@@ -543,9 +404,9 @@ void Parser::parse_point() {
 			t = next_token();
 
 			if(t.type != OPERATOR)
-				print_error(t, "expected an operator (+, -, * or /).");
+				raise_error(t, "expected an operator (+, -, * or /).");
 
-			switch(t.content.at(0)) {
+			switch(get_content(t).at(0)) {
 				case '+':
 				case '-':
 					do {
@@ -563,17 +424,17 @@ void Parser::parse_point() {
 
 					break;
 
-				default: print_error(t, "unknown operator.");
+				default: raise_error(t, "unknown operator.");
 			}
 
 			t = next_token();
 
 			if(t.type != CLOSE_PAR)
-				print_error(t, "expected ')' (got '" + t.content + "').");
+				raise_error(t, "expected ')' (got '" + get_content(t) + "').");
 
 			break;
 
-		default: print_error(t, "expected a valid point definition.");
+		default: raise_error(t, "expected a valid point definition.");
 	}
 }
 
@@ -582,28 +443,45 @@ void Parser::parse_point() {
 /***************************/
 
 /**
- * This method is used to print a message in the stderr
- * and stops the execution of the program with an error code.
+ * This method is used to stop the parsing with an error (cfr. 'ParseError').
+ *
+ * An error of the lexer (even further in the file) is always reported first,
+ * so the rest of the file is converted before.
  *
- * @param msg the msg to print in the stderr
+ * @param msg the message of the error
  */
-[[noreturn]] void Parser::print_error(const string& msg) const {
-	cerr << msg << endl;
+[[noreturn]] void Parser::raise_error(const string& msg) {
+	stream.drain();
 
-	exit(EXIT_FAILURE);
+	if(lexer.failed())
+		raise_lexer_error();
+
+	throw ParseError(msg);
 }
 
 /**
- * This method is used to print a message in the stderr with information about the wrong token,
+ * This method is used to stop the parsing with an error about the wrong token,
  * according to the format explained in the project guidelines.
  *
  * @param t the wrong token
- * @param msg the msg to print in the stderr
+ * @param msg the message of the error
+ */
+[[noreturn]] void Parser::raise_error(const token& t, const string& msg) {
+	stream.drain();
+
+	if(lexer.failed())
+		raise_lexer_error();
+
+	throw ParseError(filename + ":" + to_string(t.line) + ":" + to_string(t.col) + ": error: " + msg);
+}
+
+/**
+ * This method is used to stop the parsing with the error of the lexer.
  */
-[[noreturn]] void Parser::print_error(const token& t, const string& msg) const {
-	cerr << filename << ":" << t.line << ":" << t.col << ": error: " << msg << endl;
+[[noreturn]] void Parser::raise_lexer_error() const {
+	const token& t = lexer.get_error_token();
 
-	exit(EXIT_FAILURE);
+	throw ParseError(filename + ":" + to_string(t.line) + ":" + to_string(t.col) + ": error: " + lexer.get_error_message());
 }
 
 /*******************/
@@ -625,24 +503,3 @@ bool Parser::is_in(const vector<char>& v, const char& c) const {
 
 	return false;
 }
-
-/**
- * This method is used to check if a given token is in a vector of tokens.
- * If the token already exists in the vector, the existing token is assigned to 'exist'.
- *
- * @param v the vector of tokens
- * @param t the token
- * @param exist the existing token (if already exists)
- *
- * @return a boolean value indicating if the token 't' is in the vector of tokens 'v'
- */
-bool Parser::is_in(const vector<token>& v, const token& t, token& exist) const {
-	for(token v_t : v)
-		if(v_t.content == t.content) {
-			exist = v_t;
-
-			return true;
-		}
-
-	return false;
-}
@@ -3,6 +3,11 @@
 
 #include <string>
 #include <vector>
+#include <unordered_map>
+#include <iostream>
+#include <stdexcept>
+
+#include "lexer.hpp"
 
 /// This enum defines the different possible operations for the 'parse_name' method.
 enum parse_name_type : unsigned int {
@@ -13,94 +18,102 @@ enum parse_name_type : unsigned int {
 	CHECK_COLOR
 };
 
-/// This enum defines the different possible types of token.
-enum type : unsigned int {
-	END,			/// End of file
-	STRING,			/// fig_circle, x
-	NUMBER,			/// +3, .4, 5.0, -1.
-	POINT,			/// .
-	OPEN_BRACE,		/// {
-	CLOSE_BRACE,	/// }
-	OPEN_PAR,		/// (
-	CLOSE_PAR,		/// )
-	OPERATOR		/// +, -, *, /
+/**
+ * A definition is the position in the file ('line' and 'col')
+ * of the name of a shape or of a color when it was defined.
+ */
+struct definition {
+	unsigned int line, col;
 };
 
 /**
- * A token is an element of the file that is defined by
- * its position in the file ('line' and 'col'),
- * its type (cfr. enum 'type')
- * and its 'content'.
+ * A 'ParseError' is raised when the file is not valid.
+ * Its message is the one displayed to the user (cfr. project guidelines).
  */
-struct token {
-	unsigned int line, col;
-	unsigned int type;
-	std::string content;
+class ParseError : public std::runtime_error {
+public:
+	ParseError(const std::string& msg) : std::runtime_error(msg) { }
 };
 
 /**
  * The 'Parser' class parses the contents of a file.
  * The file to be parsed is informed to the class during its instantiation.
  *
- * First, the parser takes care of converting all the content of the file into tokens.
- * Secondly, the tokens are traversed sequentially and parsed with the proper instructions.
+ * The tokens of the file (cfr. 'Lexer') are parsed with the proper instructions
+ * as soon as they are produced, so that the tokens of the whole file never exist at the same time.
+ * For large files, the tokens are produced by other threads while they are parsed.
  *
- * If an error occurs, it is displayed in the 'stderr' and the program stops.
+ * If an error occurs, the parsing stops and the error is kept, so that
+ * several files can be parsed by the same program (even at the same time).
  */
 class Parser {
 public:
 	Parser() { }
 	Parser(const std::string fname);
 
+	Parser(const Parser&) = delete;
+	Parser& operator=(const Parser&) = delete;
+
 	/**
-	 * This function is use to parse the file 'filename'.
-	 * It does this in 2 operations :
-	 * 		1. convert all the content of the file into tokens;
-	 * 		2. parse the file with the proper instructions (size first, and then the rest).
+	 * This function is use to parse the file 'filename'
+	 * with the proper instructions (size first, and then the rest).
+	 *
+	 * @param threaded a boolean value indicating if the tokens of large files can be produced by other threads
+	 *
+	 * @return a boolean value indicating if the file is valid (otherwise, cfr. 'get_error')
 	 */
-	void parse_file();
+	bool parse_file(const bool threaded = true);
 
 	/**
-	 * This function is use to print is the 'stdout' the statistics of the parsing.
+	 * This function is use to print the statistics of the parsing.
 	 * The statistics are :
 	 * 		- the number of shapes defined
 	 * 		- the number of colors defined
 	 * 		- the number of fill operations used
+	 *
+	 * @param out the stream where the statistics are printed
 	 */
-	void print_stats() const;
+	void print_stats(std::ostream& out = std::cout) const;
+
+	const std::string& get_error() const { return error; }
+
+	size_t get_nb_shapes() const { return shapes.size(); }
+	size_t get_nb_colors() const { return colors.size(); }
+	size_t get_nb_fills() const { return nb_fills; }
 
 private:
-	/// Vectors of special points and chars in the paint file.
+	/// Vector of special points in the paint file.
 	const std::vector<char> SPECIAL_POINTS{'x', 'y'};
-	const std::vector<char> SPECIAL_CHARS{'#', '{', '}', '(', ')', '*', '/', char(32)}; /// char(32) = ' '
+
+	/// Size of the files whose tokens are produced by other threads (4 MiB).
+	static const size_t THREADED_SIZE = 4 << 20;
 
 	/// The file that the parser parse.
 	std::string filename;
 
-	/// The content of the file, converted to tokens (always ending by a "END" token).
-	std::vector<token> file_content;
+	/// The tokens of the file, and the block of tokens being parsed.
+	Lexer lexer;
+	TokenStream stream{lexer};
 
-	/// Informations about the 'file_content' for 'next_token' method.
-	unsigned int file_content_pos = 0;
-	unsigned int file_content_size;
+	std::vector<token> block;
+	size_t block_pos = 0;
 
 	/// Informations about the parsing operation.
-	std::vector<token> shapes;
-	std::vector<token> colors;
-	std::vector<token> fills;
+	/// The shapes and colors are indexed by their name (each name is defined only once).
+	std::unordered_map<std::string, definition> shapes;
+	std::unordered_map<std::string, definition> colors;
+	unsigned int nb_fills = 0;
 
-	/****************************/
-	/* Token conversion methods */
-	/****************************/
-	token create_token(const unsigned int line, const unsigned int col, const std::string content, std::ifstream& file) const;
-	token create_token(const unsigned int line, const unsigned int col, const unsigned int type, const std::string content) const;
-
-	void push_token(const token t, std::string& buffer);
-
-	void convert_token();
+	/// The error that stopped the parsing (if any).
+	std::string error;
 
+	/************************/
+	/* Token access methods */
+	/************************/
 	token next_token(const int& incr);
 
+	std::string get_content(const token& t) const;
+
 	/*******************/
 	/* Parsing methods */
 	/*******************/
@@ -129,14 +142,14 @@ private:
 	/***************************/
 	/* Error management method */
 	/***************************/
-	[[noreturn]] void print_error(const std::string& msg) const;
-	[[noreturn]] void print_error(const token& t, const std::string& msg) const;
+	[[noreturn]] void raise_error(const std::string& msg);
+	[[noreturn]] void raise_error(const token& t, const std::string& msg);
+	[[noreturn]] void raise_lexer_error() const;
 
 	/*******************/
 	/* Utility methods */
 	/*******************/
 	bool is_in(const std::vector<char>& v, const char& c) const;
-	bool is_in(const std::vector<token>& v, const token& t, token& exist) const;
 };
 
 #endif
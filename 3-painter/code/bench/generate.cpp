@@ -0,0 +1,434 @@
+/**
+ * Object-oriented programming project - Project 3
+ * Drawing geometric figures
+ *
+ * Generator of paint files for the benchmarks of the parsers. The generated
+ * file only depends on the options (the same options always give the same file),
+ * and is valid for the parser of this project (and for the one of project 2
+ * when no ellipse is generated).
+ *
+ * The number of each instruction is given by the options (and multiplied by the scale),
+ * the instructions being mixed in a random order. The points are either literal points,
+ * named points of previous shapes or arithmetic expressions of points.
+ *
+ * @author Maxime Meurisse (m.meurisse@student.uliege.be) - 20161278
+ * @version 2019.05.15
+ */
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+
+using namespace std;
+
+/// Size of the generated image.
+static const uint64_t SIZE = 1000;
+
+/// The instructions that can be generated (in the order of their options).
+enum kind : unsigned int {
+	CIRC, ELLI, RECT, TRI, SHIFT, ROT, UNION, DIFF, COLOR, FILL, NB_KINDS
+};
+
+static const char* const KIND_NAMES[NB_KINDS] = {
+	"circ", "elli", "rect", "tri", "shift", "rot", "union", "diff", "color", "fill"
+};
+
+/// Default number of each instruction (10 000 instructions in total).
+static const uint64_t DEFAULT_COUNTS[NB_KINDS] = {
+	2000, 1000, 2000, 1000, 1000, 1000, 500, 500, 200, 800
+};
+
+/// Named points of the shapes : the ones of circles, ellipses and rectangles,
+/// and the ones of triangles (the transformed shapes have the points of their first shape).
+static const char* const COMPASS_POINTS[] = {"c", "n", "ne", "e", "se", "s", "sw", "w", "nw"};
+static const char* const TRI_POINTS[] = {"c", "v0", "v1", "v2", "s01", "s02", "s12"};
+
+/**
+ * Random numbers generator (xorshift64*). Its values don't depend on the standard
+ * library, so the generated files are the same everywhere.
+ */
+class Random {
+public:
+	Random(uint64_t seed) : state(seed * 2685821657736338717ULL + 1) { }
+
+	/**
+	 * Return a random number between 0 and 'n' - 1.
+	 */
+	uint64_t next(uint64_t n) {
+		state ^= state >> 12;
+		state ^= state << 25;
+		state ^= state >> 27;
+
+		return ((state * 2685821657736338717ULL) >> 11) % n;
+	}
+
+	/**
+	 * Return true with a probability of 'percent' %.
+	 */
+	bool chance(uint64_t percent) {
+		return next(100) < percent;
+	}
+
+private:
+	uint64_t state;
+};
+
+/**
+ * The generator of the content of a paint file.
+ */
+class Generator {
+public:
+	Generator(uint64_t seed, uint64_t p, uint64_t e, uint64_t d) : random(seed), points(p), exprs(e), depth(d) { }
+
+	/**
+	 * Generate the instructions (in the given order) and write them.
+	 *
+	 * @param kinds the instructions
+	 * @param file the output file
+	 */
+	void generate(const vector<kind>& kinds, FILE* file) {
+		out = "size " + to_string(SIZE) + " " + to_string(SIZE) + "\n";
+
+		for(kind k : kinds) {
+			instruction(k);
+
+			if(out.size() > (1 << 20)) {
+				fwrite(out.data(), 1, out.size(), file);
+				out.clear();
+			}
+		}
+
+		fwrite(out.data(), 1, out.size(), file);
+	}
+
+private:
+	Random random;
+	uint64_t points, exprs, depth;
+
+	/// The named points of each shape (true for the points of a triangle),
+	/// and the number of shapes and colors defined before the current instruction.
+	vector<bool> shapes;
+	uint64_t nb_shapes = 0, nb_colors = 0;
+
+	string out;
+
+	/**
+	 * Write a number between 'min' and 'max' (with one decimal).
+	 */
+	void number(uint64_t min, uint64_t max) {
+		uint64_t n = min * 10 + random.next((max - min) * 10 + 1);
+
+		out += to_string(n / 10);
+
+		if(n % 10 != 0)
+			out += "." + to_string(n % 10);
+	}
+
+	/**
+	 * Write a reference to a previous shape.
+	 *
+	 * @return the index of the shape
+	 */
+	uint64_t shape_ref() {
+		uint64_t i = random.next(nb_shapes);
+
+		out += "s" + to_string(i);
+
+		return i;
+	}
+
+	/**
+	 * Write a point : a literal point, a named point or an expression.
+	 *
+	 * @param level the depth of the point in an expression
+	 */
+	void point(uint64_t level = 0) {
+		uint64_t r = random.next(100);
+
+		if(r < points) {
+			uint64_t i = shape_ref();
+
+			if(shapes[i])
+				out += "." + string(TRI_POINTS[random.next(7)]);
+			else
+				out += "." + string(COMPASS_POINTS[random.next(9)]);
+		} else if(r < points + exprs && level < depth) {
+			switch(random.next(4)) {
+				case 0:
+					out += "(+ ";
+					point(level + 1);
+					out += " ";
+					point(level + 1);
+					break;
+
+				case 1:
+					out += "(- ";
+					point(level + 1);
+					out += " ";
+					point(level + 1);
+					break;
+
+				case 2:
+					out += "(* ";
+					point(level + 1);
+					out += " ";
+					number(1, 4);
+					break;
+
+				default:
+					out += "(/ ";
+					point(level + 1);
+					out += " ";
+					number(1, 4);
+			}
+
+			out += ")";
+		} else {
+			out += "{";
+			number(0, SIZE);
+			out += " ";
+			number(0, SIZE);
+			out += "}";
+		}
+	}
+
+	/**
+	 * Write a color : a literal color, or a previous color (if any).
+	 */
+	void color() {
+		if(nb_colors > 0 && random.chance(50)) {
+			out += "k" + to_string(random.next(nb_colors));
+
+			return;
+		}
+
+		out += "{";
+
+		for(int i = 0; i < 3; i++) {
+			uint64_t c = random.next(1001);
+
+			out += (i > 0 ? " " : "") + (c == 1000 ? string("1") : "0." + to_string(c));
+		}
+
+		out += "}";
+	}
+
+	/**
+	 * Write a new shape name.
+	 *
+	 * @param tri a boolean value indicating if the shape has the named points of a triangle
+	 */
+	void new_shape(bool tri) {
+		out += " s" + to_string(shapes.size()) + " ";
+		shapes.push_back(tri);
+	}
+
+	/**
+	 * Write an instruction.
+	 */
+	void instruction(kind k) {
+		out += KIND_NAMES[k];
+
+		switch(k) {
+			case CIRC:
+				new_shape(false);
+				point();
+				out += " ";
+				number(1, 100);
+				break;
+
+			case ELLI: {
+				new_shape(false);
+				point();
+
+				/// The semi-major radius is the first one.
+				uint64_t b = 1 + random.next(50);
+
+				out += " " + to_string(b + random.next(50)) + " " + to_string(b);
+				break;
+			}
+
+			case RECT:
+				new_shape(false);
+				point();
+				out += " ";
+				number(1, 200);
+				out += " ";
+				number(1, 200);
+				break;
+
+			case TRI:
+				new_shape(true);
+				point();
+				out += " ";
+				point();
+				out += " ";
+				point();
+				break;
+
+			case SHIFT: {
+				uint64_t ref = random.next(nb_shapes);
+
+				new_shape(shapes[ref]);
+				point();
+				out += " s" + to_string(ref);
+				break;
+			}
+
+			case ROT: {
+				uint64_t ref = random.next(nb_shapes);
+
+				new_shape(shapes[ref]);
+				number(0, 360);
+				out += " ";
+				point();
+				out += " s" + to_string(ref);
+				break;
+			}
+
+			case UNION: {
+				uint64_t first = random.next(nb_shapes);
+				uint64_t size = 1 + random.next(4);
+
+				new_shape(shapes[first]);
+				out += "{s" + to_string(first);
+
+				for(uint64_t i = 0; i < size; i++) {
+					out += " ";
+					shape_ref();
+				}
+
+				out += "}";
+				break;
+			}
+
+			case DIFF: {
+				uint64_t ref = random.next(nb_shapes);
+
+				new_shape(shapes[ref]);
+				out += "s" + to_string(ref) + " ";
+				shape_ref();
+				break;
+			}
+
+			case COLOR:
+				out += " k" + to_string(nb_colors) + " ";
+				color();
+				break;
+
+			default:
+				out += " ";
+				shape_ref();
+				out += " ";
+				color();
+		}
+
+		out += "\n";
+
+		nb_shapes = shapes.size();
+		nb_colors += (k == COLOR);
+	}
+};
+
+/**
+ * Return the instructions to generate, in a random order where each instruction
+ * using shapes comes after a shape definition.
+ *
+ * @param counts the number of each instruction
+ * @param seed the seed of the order
+ * @return the instructions
+ */
+static vector<kind> shuffle(const uint64_t counts[NB_KINDS], uint64_t seed) {
+	Random random(seed ^ 0x5bd1e995);
+	vector<kind> kinds;
+
+	for(unsigned int k = 0; k < NB_KINDS; k++)
+		kinds.insert(kinds.end(), counts[k], kind(k));
+
+	for(size_t i = kinds.size(); i > 1; i--)
+		swap(kinds[i - 1], kinds[random.next(i)]);
+
+	/// The first primitive shape is moved before the instructions using shapes.
+	for(size_t i = 0; i < kinds.size(); i++) {
+		if(kinds[i] <= TRI) {
+			swap(kinds[0], kinds[i]);
+
+			return kinds;
+		}
+	}
+
+	if(kinds.size() > counts[COLOR]) {
+		cerr << "At least one circ, elli, rect or tri instruction is needed." << endl;
+
+		exit(EXIT_FAILURE);
+	}
+
+	return kinds;
+}
+
+int main(int argc, char* argv[]) {
+	uint64_t counts[NB_KINDS], scale = 1, seed = 1, points = 30, exprs = 20, depth = 3;
+
+	for(unsigned int k = 0; k < NB_KINDS; k++)
+		counts[k] = DEFAULT_COUNTS[k];
+
+	/// Retrieving options.
+	for(int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		bool found = false;
+
+		if(arg.size() < 2 || arg[0] != '-' || i + 1 == argc) {
+			cerr << "Usage : " << argv[0] << " [-scale K] [-seed S] [-points PERCENT] [-exprs PERCENT] [-depth D]";
+
+			for(unsigned int k = 0; k < NB_KINDS; k++)
+				cerr << " [-" << KIND_NAMES[k] << " N]";
+
+			cerr << endl;
+
+			return 1;
+		}
+
+		uint64_t value = strtoull(argv[++i], nullptr, 10);
+
+		for(unsigned int k = 0; k < NB_KINDS; k++) {
+			if(arg.substr(1) == KIND_NAMES[k]) {
+				counts[k] = value;
+				found = true;
+			}
+		}
+
+		if(arg == "-scale")
+			scale = value;
+		else if(arg == "-seed")
+			seed = value;
+		else if(arg == "-points")
+			points = value;
+		else if(arg == "-exprs")
+			exprs = value;
+		else if(arg == "-depth")
+			depth = value;
+		else if(!found) {
+			cerr << "Unknown option '" << arg << "'." << endl;
+
+			return 1;
+		}
+	}
+
+	if(points + exprs > 100) {
+		cerr << "The percentages of named points and expressions must not exceed 100." << endl;
+
+		return 1;
+	}
+
+	for(unsigned int k = 0; k < NB_KINDS; k++)
+		counts[k] *= scale;
+
+	Generator generator(seed, points, exprs, depth);
+
+	generator.generate(shuffle(counts, seed), stdout);
+
+	return 0;
+}
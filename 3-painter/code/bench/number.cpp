@@ -0,0 +1,187 @@
+/**
+ * Object-oriented programming project - Project 3
+ * Drawing geometric figures
+ *
+ * Micro-benchmark of the conversion of the number tokens : 'atof' on the content
+ * of the tokens (as before) against the scanner of the lexer. It also checks that
+ * both give exactly the same doubles, on the numbers of the paint files and on
+ * random numbers.
+ *
+ * @author Maxime Meurisse (m.meurisse@student.uliege.be) - 20161278
+ * @version 2019.05.15
+ */
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <random>
+#include <cstring>
+#include <cstdlib>
+
+#include <dirent.h>
+#include <unistd.h>
+
+#include "../src/headers/lexer.hpp"
+
+using namespace std;
+
+/// Number of conversions of all the numbers of the corpus.
+static const int ROUNDS = 200;
+
+/**
+ * Check that the scanner gives the same doubles as 'atof' on some numbers.
+ *
+ * @param lexer the lexer of the numbers
+ * @param tokens the number tokens
+ * @return the number of differences
+ */
+static size_t check(const Lexer& lexer, const vector<token>& tokens) {
+	size_t errors = 0;
+
+	for(const token& t : tokens) {
+		double a = ::atof(lexer.get_content(t).c_str()), b = lexer.get_number(t);
+
+		if(memcmp(&a, &b, sizeof(double)) != 0) {
+			if(errors++ < 10)
+				cerr << "Mismatch for '" << lexer.get_content(t) << "'" << endl;
+		}
+	}
+
+	return errors;
+}
+
+/**
+ * Get the number tokens of a paint file.
+ *
+ * @param lexer the lexer of the file
+ * @param filename the paint file
+ * @return the number tokens of the file
+ */
+static vector<token> numbers(Lexer& lexer, const string& filename) {
+	vector<token> tokens, block(TokenStream::BLOCK_SIZE);
+	size_t n;
+
+	if(!lexer.open(filename)) {
+		cerr << "Unable to open " << filename << endl;
+
+		exit(EXIT_FAILURE);
+	}
+
+	while((n = lexer.read(block.data(), block.size())) > 0)
+		for(size_t i = 0; i < n; i++)
+			if(block[i].type == NUMBER)
+				tokens.push_back(block[i]);
+
+	return tokens;
+}
+
+int main(int argc, char* argv[]) {
+	string directory = (argc > 1) ? argv[1] : "ppm-check/ref_paint";
+	vector<string> files;
+	size_t errors = 0, count = 0;
+
+	/* Corpus */
+
+	DIR* dir = opendir(directory.c_str());
+
+	if(!dir) {
+		cerr << "Unable to open directory '" << directory << "'." << endl;
+
+		return 1;
+	}
+
+	for(dirent* e = readdir(dir); e; e = readdir(dir)) {
+		string name = e->d_name;
+
+		if(name.size() > 6 && name.substr(name.size() - 6) == ".paint")
+			files.push_back(directory + "/" + name);
+	}
+
+	closedir(dir);
+
+	vector<Lexer> lexers(files.size());
+	vector<vector<token>> tokens;
+
+	for(size_t i = 0; i < files.size(); i++) {
+		tokens.push_back(numbers(lexers[i], files[i]));
+		errors += check(lexers[i], tokens.back());
+		count += tokens.back().size();
+	}
+
+	/* Random numbers */
+
+	char path[] = "/tmp/bench-number-XXXXXX";
+	int fd = mkstemp(path);
+	mt19937 generator(42);
+	string content;
+
+	for(int i = 0; i < 200000; i++) {
+		int digits = uniform_int_distribution<int>(1, 25)(generator);
+		int point = uniform_int_distribution<int>(-1, digits)(generator);
+
+		if(i % 3 == 1)
+			content += '-';
+		else if(i % 3 == 2)
+			content += '+';
+
+		for(int d = 0; d < digits; d++) {
+			if(d == point)
+				content += '.';
+
+			content += char('0' + uniform_int_distribution<int>(0, 9)(generator));
+		}
+
+		if(point == digits)
+			content += '.';
+
+		content += '\n';
+	}
+
+	if(fd < 0 || write(fd, content.data(), content.size()) != ssize_t(content.size())) {
+		cerr << "Unable to write random numbers." << endl;
+
+		return 1;
+	}
+
+	close(fd);
+
+	Lexer random_lexer;
+	vector<token> random_tokens = numbers(random_lexer, path);
+
+	errors += check(random_lexer, random_tokens);
+	unlink(path);
+
+	cout << "Numbers checked : " << count << " (corpus) + " << random_tokens.size() << " (random)" << endl;
+	cout << "Mismatches : " << errors << endl;
+
+	/* Timing */
+
+	double sum = 0;
+
+	auto start = chrono::steady_clock::now();
+
+	for(int r = 0; r < ROUNDS; r++)
+		for(size_t i = 0; i < files.size(); i++)
+			for(const token& t : tokens[i])
+				sum += ::atof(lexers[i].get_content(t).c_str());
+
+	auto middle = chrono::steady_clock::now();
+
+	for(int r = 0; r < ROUNDS; r++)
+		for(size_t i = 0; i < files.size(); i++)
+			for(const token& t : tokens[i])
+				sum -= lexers[i].get_number(t);
+
+	auto end = chrono::steady_clock::now();
+
+	auto time_atof = chrono::duration <double, milli> (middle - start).count();
+	auto time_scan = chrono::duration <double, milli> (end - middle).count();
+
+	cout << "Time (atof) : " << time_atof << " ms" << endl;
+	cout << "Time (scanner) : " << time_scan << " ms" << endl;
+	cout << "Speedup : " << time_atof / time_scan << " (checksum " << sum << ")" << endl;
+
+	return errors > 0;
+}
@@ -0,0 +1,679 @@
+/**
+ * Object-oriented programming project - Project 3
+ * Drawing geometric figures
+ *
+ * @author Maxime Meurisse (m.meurisse@student.uliege.be) - 20161278
+ * @version 2019.05.15
+ */
+
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <functional>
+#include <unordered_map>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "headers/compiler.hpp"
+#include "headers/module.hpp"
+
+using namespace std;
+
+/// Magic bytes of a compiled file (of a scene or of a module).
+static const char MAGIC[4] = {'P', 'N', 'T', 'C'};
+static const char MAGIC_MODULE[4] = {'P', 'N', 'T', 'M'};
+
+/// Types of the shapes in a compiled file.
+enum shape_type : uint8_t {
+	SHAPE_CIRC,
+	SHAPE_ELLI,
+	SHAPE_RECT,
+	SHAPE_TRI,
+	SHAPE_SHIFT,
+	SHAPE_ROT,
+	SHAPE_UNION,
+	SHAPE_DIFF
+};
+
+/**
+ * A file mapped in memory (read only), unmapped when it is destroyed.
+ */
+struct Mapping {
+	Mapping(const string& filename) {
+		struct stat st;
+		int fd = open(filename.c_str(), O_RDONLY);
+
+		if(fd < 0)
+			return;
+
+		if(fstat(fd, &st) == 0) {
+			size = size_t(st.st_size);
+			valid = true;
+
+			if(size > 0) {
+				void* m = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+				if(m == MAP_FAILED)
+					valid = false;
+				else
+					data = static_cast<const char*>(m);
+			}
+		}
+
+		close(fd);
+	}
+
+	~Mapping() {
+		if(data)
+			munmap(const_cast<char*>(data), size);
+	}
+
+	Mapping(const Mapping&) = delete;
+	Mapping& operator=(const Mapping&) = delete;
+
+	const char* data = nullptr;
+	size_t size = 0;
+	bool valid = false;
+};
+
+/**
+ * Append the bytes of a value to a buffer.
+ */
+template<typename T>
+static void put(string& out, const T& v) {
+	out.append(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+static void put(string& out, const Point& p) {
+	put(out, p.x);
+	put(out, p.y);
+}
+
+static void put(string& out, const string& s) {
+	put(out, uint32_t(s.size()));
+	out += s;
+}
+
+/// The files are saved with the hash of their content.
+static void put(string& out, const vector<pair<string, uint64_t>>& files) {
+	put(out, uint32_t(files.size()));
+
+	for(const auto& f : files) {
+		put(out, f.first);
+		put(out, f.second);
+	}
+}
+
+/**
+ * Read the bytes of a value from a buffer (if there are enough bytes left).
+ */
+template<typename T>
+static bool get(const char*& pos, const char* end, T& v) {
+	if(size_t(end - pos) < sizeof(T))
+		return false;
+
+	memcpy(&v, pos, sizeof(T));
+	pos += sizeof(T);
+
+	return true;
+}
+
+static bool get(const char*& pos, const char* end, Point& p) {
+	return get(pos, end, p.x) && get(pos, end, p.y);
+}
+
+static bool get(const char*& pos, const char* end, string& s) {
+	uint32_t size;
+
+	if(!get(pos, end, size) || size_t(end - pos) < size)
+		return false;
+
+	s.assign(pos, size);
+	pos += size;
+
+	return true;
+}
+
+static bool get(const char*& pos, const char* end, vector<pair<string, uint64_t>>& files) {
+	uint32_t nb;
+
+	if(!get(pos, end, nb))
+		return false;
+
+	for(uint32_t i = 0; i < nb; i++) {
+		pair<string, uint64_t> f;
+
+		if(!get(pos, end, f.first) || !get(pos, end, f.second))
+			return false;
+
+		files.push_back(f);
+	}
+
+	return true;
+}
+
+/**
+ * Return the hash (FNV-1a, 64 bits) of bytes.
+ */
+static uint64_t hash_bytes(const char* data, size_t size) {
+	uint64_t hash = 14695981039346656037ULL;
+
+	for(size_t i = 0; i < size; i++) {
+		hash ^= uint8_t(data[i]);
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+/**
+ * Return a boolean value indicating if files still have the same content (the same hash).
+ */
+static bool up_to_date(const vector<pair<string, uint64_t>>& files) {
+	for(const auto& f : files) {
+		uint64_t hash;
+
+		if(!Compiler::hash_file(f.first, hash) || hash != f.second)
+			return false;
+	}
+
+	return true;
+}
+
+/**
+ * Write a buffer in a file, followed by its checksum (its hash).
+ *
+ * @return a boolean value indicating if the file could be written
+ */
+static bool write_file(const string& filename, string& out) {
+	ofstream file(filename, ios::binary);
+
+	put(out, hash_bytes(out.data(), out.size()));
+
+	file.write(out.data(), streamsize(out.size()));
+	file.close();
+
+	return bool(file);
+}
+
+/************/
+/* COMPILER */
+/************/
+
+const uint32_t Compiler::VERSION;
+
+/**
+ * Check the magic bytes and the checksum of a compiled file.
+ *
+ * @param file the compiled file
+ * @param magic the expected magic bytes
+ * @param pos the position after the magic bytes
+ * @param end the position of the checksum
+ * @return a boolean value indicating if the file is not damaged
+ */
+static bool check_file(const Mapping& file, const char (&magic)[4], const char*& pos, const char*& end) {
+	uint64_t checksum;
+
+	if(!file.valid || file.size < sizeof(magic) + sizeof(checksum) || memcmp(file.data, magic, sizeof(magic)) != 0)
+		return false;
+
+	pos = file.data + sizeof(magic);
+	end = file.data + file.size - sizeof(checksum);
+
+	memcpy(&checksum, end, sizeof(checksum));
+
+	return checksum == hash_bytes(file.data, file.size - sizeof(checksum));
+}
+
+bool Compiler::hash_file(const string& filename, uint64_t& hash) {
+	Mapping file(filename);
+
+	if(!file.valid)
+		return false;
+
+	hash = hash_bytes(file.data, file.size);
+
+	return true;
+}
+
+bool Compiler::save(const string& filename, const Scene& scene, uint64_t source_hash) {
+	string shapes;
+	unordered_map<const Shape*, uint32_t> index;
+	vector<uint32_t> fills;
+
+	for(const auto& fill : scene.fills)
+		fills.push_back(save_shape(fill.first.get(), shapes, index));
+
+	string out(MAGIC, sizeof(MAGIC));
+
+	put(out, VERSION);
+	put(out, source_hash);
+	put(out, uint64_t(scene.width));
+	put(out, uint64_t(scene.height));
+	put(out, uint64_t(scene.nb_shapes));
+	put(out, uint64_t(scene.nb_colors));
+	put(out, uint64_t(scene.nb_shared));
+	put(out, scene.imports);
+	put(out, uint32_t(index.size()));
+	put(out, uint32_t(fills.size()));
+
+	out += shapes;
+
+	for(size_t f = 0; f < fills.size(); f++) {
+		Color color = scene.fills[f].second;
+
+		put(out, fills[f]);
+		put(out, color.red);
+		put(out, color.green);
+		put(out, color.blue);
+	}
+
+	return write_file(filename, out);
+}
+
+bool Compiler::load(const string& filename, uint64_t source_hash, Scene& scene) {
+	Mapping file(filename);
+	const char *pos, *end;
+
+	if(!check_file(file, MAGIC, pos, end))
+		return false;
+
+	uint32_t version, nb_nodes, nb_fills;
+	uint64_t hash, width, height, nb_shapes, nb_colors, nb_shared;
+	vector<pair<string, uint64_t>> imports;
+
+	if(!get(pos, end, version) || version != VERSION)
+		return false;
+
+	if(!get(pos, end, hash) || hash != source_hash)
+		return false;
+
+	if(!get(pos, end, width) || !get(pos, end, height) || !get(pos, end, nb_shapes) || !get(pos, end, nb_colors) || !get(pos, end, nb_shared))
+		return false;
+
+	/// The pixels of the image must fit in memory.
+	if(width > SIZE_MAX || height > SIZE_MAX || (height > 0 && width > SIZE_MAX / sizeof(pair<bool, Color>) / height))
+		return false;
+
+	/// The scene is stale if one of the modules it imports has changed.
+	if(!get(pos, end, imports) || !up_to_date(imports))
+		return false;
+
+	/// Each fill takes 7 bytes (the index of its shape and its color) at the end of the file.
+	if(!get(pos, end, nb_nodes) || !get(pos, end, nb_fills) || size_t(end - pos) / (sizeof(uint32_t) + 3) < nb_fills)
+		return false;
+
+	vector<shared_ptr<Shape>> nodes;
+
+	if(!load_shapes(pos, end, nb_nodes, nodes))
+		return false;
+
+	vector<Fill> fills;
+
+	for(uint32_t f = 0; f < nb_fills; f++) {
+		uint32_t i;
+		Color color;
+
+		if(!get(pos, end, i) || i >= nodes.size())
+			return false;
+
+		if(!get(pos, end, color.red) || !get(pos, end, color.green) || !get(pos, end, color.blue))
+			return false;
+
+		fills.emplace_back(nodes[i], color);
+	}
+
+	if(pos != end)
+		return false;
+
+	scene.fills = move(fills);
+	scene.width = size_t(width);
+	scene.height = size_t(height);
+	scene.nb_shapes = size_t(nb_shapes);
+	scene.nb_colors = size_t(nb_colors);
+	scene.nb_shared = size_t(nb_shared);
+	scene.imports = move(imports);
+
+	return true;
+}
+
+bool Compiler::save_module(const string& filename, const Module& module) {
+	string shapes;
+	unordered_map<const Shape*, uint32_t> index;
+	vector<pair<uint32_t, string>> externals;
+
+	/// The shapes of the imported modules are referred by their module and their name.
+	for(uint32_t i = 0; i < module.imports.size(); i++) {
+		for(const auto& s : module.imports[i]->shapes) {
+			if(index.count(s.second.get()) == 0) {
+				index[s.second.get()] = uint32_t(externals.size());
+				externals.emplace_back(i, s.first);
+			}
+		}
+	}
+
+	vector<pair<string, uint32_t>> names;
+
+	for(const auto& s : module.shapes)
+		names.emplace_back(s.first, save_shape(s.second.get(), shapes, index));
+
+	string out(MAGIC_MODULE, sizeof(MAGIC_MODULE));
+
+	put(out, VERSION);
+	put(out, module.files);
+	put(out, uint32_t(module.imports.size()));
+
+	for(const auto& import : module.imports)
+		put(out, import->filename);
+
+	put(out, uint32_t(externals.size()));
+
+	for(const auto& e : externals) {
+		put(out, e.first);
+		put(out, e.second);
+	}
+
+	put(out, uint32_t(index.size() - externals.size()));
+
+	out += shapes;
+
+	put(out, uint32_t(names.size()));
+
+	for(const auto& n : names) {
+		put(out, n.first);
+		put(out, n.second);
+	}
+
+	put(out, uint32_t(module.colors.size()));
+
+	for(const auto& c : module.colors) {
+		put(out, c.first);
+		put(out, c.second.red);
+		put(out, c.second.green);
+		put(out, c.second.blue);
+	}
+
+	return write_file(filename, out);
+}
+
+bool Compiler::load_module(const string& filename, Module& module) {
+	Mapping file(filename);
+	const char *pos, *end;
+
+	if(!check_file(file, MAGIC_MODULE, pos, end))
+		return false;
+
+	uint32_t version, nb_imports, nb_externals, nb_nodes, nb_names, nb_colors;
+	Module loaded;
+
+	if(!get(pos, end, version) || version != VERSION)
+		return false;
+
+	/// The module is stale if its file (or one of the modules it imports) has changed.
+	if(!get(pos, end, loaded.files) || loaded.files.empty() || loaded.files[0].first != module.filename || !up_to_date(loaded.files))
+		return false;
+
+	if(!get(pos, end, nb_imports))
+		return false;
+
+	for(uint32_t i = 0; i < nb_imports; i++) {
+		string path;
+		Diagnostic error;
+
+		if(!get(pos, end, path))
+			return false;
+
+		shared_ptr<const Module> import = Modules::load(path, error);
+
+		if(!import)
+			return false;
+
+		loaded.imports.push_back(import);
+	}
+
+	vector<shared_ptr<Shape>> nodes;
+
+	if(!get(pos, end, nb_externals))
+		return false;
+
+	for(uint32_t e = 0; e < nb_externals; e++) {
+		uint32_t i;
+		string name;
+
+		if(!get(pos, end, i) || !get(pos, end, name) || i >= loaded.imports.size())
+			return false;
+
+		auto it = loaded.imports[i]->shapes.find(name);
+
+		if(it == loaded.imports[i]->shapes.end())
+			return false;
+
+		nodes.push_back(it->second);
+	}
+
+	if(!get(pos, end, nb_nodes) || !load_shapes(pos, end, nb_nodes, nodes))
+		return false;
+
+	if(!get(pos, end, nb_names))
+		return false;
+
+	for(uint32_t n = 0; n < nb_names; n++) {
+		string name;
+		uint32_t i;
+
+		if(!get(pos, end, name) || !get(pos, end, i) || i >= nodes.size())
+			return false;
+
+		loaded.shapes[name] = nodes[i];
+	}
+
+	if(!get(pos, end, nb_colors))
+		return false;
+
+	for(uint32_t n = 0; n < nb_colors; n++) {
+		string name;
+		Color color;
+
+		if(!get(pos, end, name) || !get(pos, end, color.red) || !get(pos, end, color.green) || !get(pos, end, color.blue))
+			return false;
+
+		loaded.colors[name] = color;
+	}
+
+	if(pos != end)
+		return false;
+
+	loaded.filename = module.filename;
+	module = move(loaded);
+
+	return true;
+}
+
+uint32_t Compiler::save_shape(const Shape* s, string& out, unordered_map<const Shape*, uint32_t>& index) {
+	auto it = index.find(s);
+
+	if(it != index.end())
+		return it->second;
+
+	string node;
+
+	if(auto circ = dynamic_cast<const Circ*>(s)) {
+		put(node, SHAPE_CIRC);
+		put(node, circ->c);
+		put(node, circ->a);
+	} else if(auto elli = dynamic_cast<const Elli*>(s)) {
+		put(node, SHAPE_ELLI);
+		put(node, elli->c);
+		put(node, elli->a);
+		put(node, elli->b);
+	} else if(auto rect = dynamic_cast<const Rect*>(s)) {
+		put(node, SHAPE_RECT);
+		put(node, rect->c);
+		put(node, rect->width);
+		put(node, rect->height);
+	} else if(auto tri = dynamic_cast<const Tri*>(s)) {
+		put(node, SHAPE_TRI);
+		put(node, tri->v0);
+		put(node, tri->v1);
+		put(node, tri->v2);
+	} else if(auto shift = dynamic_cast<const Shift*>(s)) {
+		uint32_t ref = save_shape(shift->ref_shape.get(), out, index);
+
+		put(node, SHAPE_SHIFT);
+		put(node, shift->t);
+		put(node, ref);
+	} else if(auto rot = dynamic_cast<const Rot*>(s)) {
+		uint32_t ref = save_shape(rot->ref_shape.get(), out, index);
+
+		/// The sinus and cosinus are saved (and not the angle) to get exactly the same values.
+		put(node, SHAPE_ROT);
+		put(node, rot->sin_a);
+		put(node, rot->cos_a);
+		put(node, rot->r);
+		put(node, ref);
+	} else if(auto uni = dynamic_cast<const Union*>(s)) {
+		vector<uint32_t> refs;
+
+		for(const auto& shape : uni->shapes)
+			refs.push_back(save_shape(shape.get(), out, index));
+
+		put(node, SHAPE_UNION);
+		put(node, uint32_t(refs.size()));
+
+		for(uint32_t ref : refs)
+			put(node, ref);
+	} else {
+		auto diff = static_cast<const Diff*>(s);
+		uint32_t ref_in = save_shape(diff->shape_in.get(), out, index);
+		uint32_t ref_out = save_shape(diff->shape_out.get(), out, index);
+
+		put(node, SHAPE_DIFF);
+		put(node, ref_in);
+		put(node, ref_out);
+	}
+
+	out += node;
+
+	uint32_t i = uint32_t(index.size());
+
+	index[s] = i;
+
+	return i;
+}
+
+bool Compiler::load_shapes(const char*& pos, const char* end, uint32_t nb_nodes, vector<shared_ptr<Shape>>& nodes) {
+	/// Read the index of a shape already loaded.
+	auto get_ref = [&pos, end, &nodes](shared_ptr<Shape>& ref) {
+		uint32_t i;
+
+		if(!get(pos, end, i) || i >= nodes.size())
+			return false;
+
+		ref = nodes[i];
+
+		return true;
+	};
+
+	for(uint32_t n = 0; n < nb_nodes; n++) {
+		uint8_t type;
+		Point c, v0, v1, v2;
+		double a, b, sin_a, cos_a;
+		shared_ptr<Shape> shape, ref, ref_out;
+
+		if(!get(pos, end, type))
+			return false;
+
+		switch(type) {
+			case SHAPE_CIRC:
+				if(!get(pos, end, c) || !get(pos, end, a))
+					return false;
+
+				shape = make_shared<Circ>(Circ(c, a));
+
+				break;
+
+			case SHAPE_ELLI:
+				if(!get(pos, end, c) || !get(pos, end, a) || !get(pos, end, b))
+					return false;
+
+				shape = make_shared<Elli>(Elli(c, a, b));
+
+				break;
+
+			case SHAPE_RECT:
+				if(!get(pos, end, c) || !get(pos, end, a) || !get(pos, end, b))
+					return false;
+
+				shape = make_shared<Rect>(Rect(c, a, b));
+
+				break;
+
+			case SHAPE_TRI:
+				if(!get(pos, end, v0) || !get(pos, end, v1) || !get(pos, end, v2))
+					return false;
+
+				shape = make_shared<Tri>(Tri(v0, v1, v2));
+
+				break;
+
+			case SHAPE_SHIFT:
+				if(!get(pos, end, c) || !get_ref(ref))
+					return false;
+
+				shape = make_shared<Shift>(Shift(c, ref));
+
+				break;
+
+			case SHAPE_ROT: {
+				if(!get(pos, end, sin_a) || !get(pos, end, cos_a) || !get(pos, end, c) || !get_ref(ref))
+					return false;
+
+				Rot rot(0, c, ref);
+
+				rot.sin_a = sin_a;
+				rot.cos_a = cos_a;
+
+				shape = make_shared<Rot>(rot);
+
+				break;
+			}
+
+			case SHAPE_UNION: {
+				uint32_t size;
+				vector<shared_ptr<Shape>> refs;
+
+				if(!get(pos, end, size) || size == 0)
+					return false;
+
+				for(uint32_t i = 0; i < size; i++) {
+					if(!get_ref(ref))
+						return false;
+
+					refs.push_back(ref);
+				}
+
+				shape = make_shared<Union>(Union(refs));
+
+				break;
+			}
+
+			case SHAPE_DIFF:
+				if(!get_ref(ref) || !get_ref(ref_out))
+					return false;
+
+				shape = make_shared<Diff>(Diff(ref, ref_out));
+
+				break;
+
+			default:
+				return false;
+		}
+
+		nodes.push_back(shape);
+	}
+
+	return true;
+}
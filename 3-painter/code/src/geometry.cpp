@@ -6,6 +6,9 @@
  * @version 2019.05.16
  */
 
+#include <cstring>
+#include <cstdint>
+
 #include "headers/geometry.hpp"
 
 using namespace std;
@@ -26,12 +29,142 @@ Point Point::rotate(Point p, double sin_a, double cos_a) const {
 	return Point(d_x * cos_a - d_y * sin_a + p.x, d_x * sin_a + d_y * cos_a + p.y);
 }
 
+/* Named points */
+
+/***************/
+/* NAMED POINT */
+/***************/
+
+/**
+ * The name is found with its length and its chars,
+ * without any comparison of strings.
+ */
+NamedPoint to_named_point(const char* name, size_t length) {
+	switch(length) {
+		case 1:
+			switch(name[0]) {
+				case 'c': return PT_C;
+				case 'n': return PT_N;
+				case 'e': return PT_E;
+				case 's': return PT_S;
+				case 'w': return PT_W;
+			}
+
+			break;
+
+		case 2:
+			switch(name[0]) {
+				case 'n':
+					if(name[1] == 'e')
+						return PT_NE;
+					else if(name[1] == 'w')
+						return PT_NW;
+
+					break;
+
+				case 's':
+					if(name[1] == 'e')
+						return PT_SE;
+					else if(name[1] == 'w')
+						return PT_SW;
+
+					break;
+
+				case 'f':
+					if(name[1] == '1')
+						return PT_F1;
+					else if(name[1] == '2')
+						return PT_F2;
+
+					break;
+
+				case 'v':
+					if(name[1] == '0')
+						return PT_V0;
+					else if(name[1] == '1')
+						return PT_V1;
+					else if(name[1] == '2')
+						return PT_V2;
+
+					break;
+			}
+
+			break;
+
+		case 3:
+			if(name[0] == 's' && name[1] == '0' && name[2] == '1')
+				return PT_S01;
+			else if(name[0] == 's' && name[1] == '0' && name[2] == '2')
+				return PT_S02;
+			else if(name[0] == 's' && name[1] == '1' && name[2] == '2')
+				return PT_S12;
+
+			break;
+	}
+
+	return NO_POINT;
+}
+
 /* Abstract shape */
 
 /*********/
 /* SHAPE */
 /*********/
 
+/**
+ * Mix a value into the hash of the structure of a shape (cfr. 'Shape::get_hash').
+ * The values are mixed with the bits of their representation (as they are compared).
+ */
+static void mix(uint64_t& h, uint64_t bits) {
+	h = (h ^ bits) * 0x9e3779b97f4a7c15;
+	h ^= h >> 32;
+}
+
+static void mix(uint64_t& h, double v) {
+	uint64_t bits;
+
+	memcpy(&bits, &v, sizeof(bits));
+	mix(h, bits);
+}
+
+static void mix(uint64_t& h, Point p) {
+	mix(h, p.x);
+	mix(h, p.y);
+}
+
+static void mix(uint64_t& h, const shared_ptr<Shape>& shape) {
+	mix(h, uint64_t(reinterpret_cast<uintptr_t>(shape.get())));
+}
+
+/**
+ * Return the hash of the structure of a shape, from its type and its values.
+ */
+template<typename... T>
+static size_t hash_values(char type, const T&... values) {
+	uint64_t h = uint64_t(type);
+	int expand[] = {0, (mix(h, values), 0)...};
+
+	(void) expand;
+
+	return size_t(h);
+}
+
+/**
+ * Compare the bits of values (so that the structures of two shapes are identical
+ * only if all their values are, cfr. 'Shape::get_hash').
+ */
+static bool same_bits(double a, double b) {
+	return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+static bool same_bits(Point a, Point b) {
+	return same_bits(a.x, b.x) && same_bits(a.y, b.y);
+}
+
+Point Shape::get_named_point(string name) const {
+	return get_named_point(to_named_point(name.data(), name.size()));
+}
+
 domain Shape::get_domain(vector<Point> vertices) const {
 	Point lb = vertices.at(0), ur = vertices.at(0);
 
@@ -58,31 +191,21 @@ domain Shape::get_domain(vector<Point> vertices) const {
 /* ELLI */
 /********/
 
-Point Elli::get_named_point(string name) const {
-	if(name == "c")
-		return c;
-	else if(name == "nw")
-		return Point(c.x - a * incr, c.y + b * incr);
-	else if(name == "n")
-		return Point(c.x, c.y + b);
-	else if(name == "ne")
-		return Point(c.x + a * incr, c.y + b * incr);
-	else if(name == "e")
-		return Point(c.x + a, c.y);
-	else if(name == "se")
-		return Point(c.x + a * incr, c.y - b * incr);
-	else if(name == "s")
-		return Point(c.x, c.y - b);
-	else if(name == "sw")
-		return Point(c.x - a * incr, c.y - b * incr);
-	else if(name == "w")
-		return Point(c.x - a, c.y);
-	else if(name == "f1")
-		return Point(c.x + d_f, c.y);
-	else if(name == "f2")
-		return Point(c.x - d_f, c.y);
-	else
-		throw invalid_argument("Point doesn't exist.");
+Point Elli::get_named_point(NamedPoint name) const {
+	switch(name) {
+		case PT_C: return c;
+		case PT_NW: return Point(c.x - a * incr, c.y + b * incr);
+		case PT_N: return Point(c.x, c.y + b);
+		case PT_NE: return Point(c.x + a * incr, c.y + b * incr);
+		case PT_E: return Point(c.x + a, c.y);
+		case PT_SE: return Point(c.x + a * incr, c.y - b * incr);
+		case PT_S: return Point(c.x, c.y - b);
+		case PT_SW: return Point(c.x - a * incr, c.y - b * incr);
+		case PT_W: return Point(c.x - a, c.y);
+		case PT_F1: return Point(c.x + d_f, c.y);
+		case PT_F2: return Point(c.x - d_f, c.y);
+		default: throw invalid_argument("Point doesn't exist.");
+	}
 }
 
 domain Elli::get_domain() const {
@@ -93,13 +216,21 @@ bool Elli::contains(Point p) const {
 	return pow((p.x - c.x) * b, 2) + pow((c.y - p.y) * a, 2) <= ab2;
 }
 
+size_t Elli::get_hash() const {
+	return hash_values('e', c, a, b);
+}
+
+bool Elli::same(const Elli& other) const {
+	return same_bits(c, other.c) && same_bits(a, other.a) && same_bits(b, other.b);
+}
+
 /********/
 /* CIRC */
 /********/
 
-Point Circ::get_named_point(string name) const {
+Point Circ::get_named_point(NamedPoint name) const {
 	/// 'f1' and 'f2' are not valid named point for 'Circ'.
-	if(name == "f1" || name == "f2")
+	if(name == PT_F1 || name == PT_F2)
 		throw invalid_argument("Point doesn't exist.");
 
 	return Elli::get_named_point(name);
@@ -113,37 +244,37 @@ bool Circ::contains(Point p) const {
 /* RECT */
 /********/
 
-Point Rect::get_named_point(string name) const {
-	if(name == "c")
-		return c;
-	else if(name == "nw")
-		return Point(c.x - mid_width, c.y + mid_height);
-	else if(name == "n")
-		return Point(c.x, c.y + mid_height);
-	else if(name == "ne")
-		return Point(c.x + mid_width, c.y + mid_height);
-	else if(name == "e")
-		return Point(c.x + mid_width, c.y);
-	else if(name == "se")
-		return Point(c.x + mid_width, c.y - mid_height);
-	else if(name == "s")
-		return Point(c.x, c.y - mid_height);
-	else if(name == "sw")
-		return Point(c.x - mid_width, c.y - mid_height);
-	else if(name == "w")
-		return Point(c.x - mid_width, c.y);
-	else
-		throw invalid_argument("Point doesn't exist.");
+Point Rect::get_named_point(NamedPoint name) const {
+	switch(name) {
+		case PT_C: return c;
+		case PT_NW: return Point(c.x - mid_width, c.y + mid_height);
+		case PT_N: return Point(c.x, c.y + mid_height);
+		case PT_NE: return Point(c.x + mid_width, c.y + mid_height);
+		case PT_E: return Point(c.x + mid_width, c.y);
+		case PT_SE: return Point(c.x + mid_width, c.y - mid_height);
+		case PT_S: return Point(c.x, c.y - mid_height);
+		case PT_SW: return Point(c.x - mid_width, c.y - mid_height);
+		case PT_W: return Point(c.x - mid_width, c.y);
+		default: throw invalid_argument("Point doesn't exist.");
+	}
 }
 
 domain Rect::get_domain() const {
-	return {get_named_point("sw"), get_named_point("ne")};
+	return {get_named_point(PT_SW), get_named_point(PT_NE)};
 }
 
 bool Rect::contains(Point p) const {
 	return abs(p.x - c.x) <= mid_width && abs(p.y - c.y) <= mid_height;
 }
 
+size_t Rect::get_hash() const {
+	return hash_values('r', c, width, height);
+}
+
+bool Rect::same(const Rect& other) const {
+	return same_bits(c, other.c) && same_bits(width, other.width) && same_bits(height, other.height);
+}
+
 /*******/
 /* TRI */
 /*******/
@@ -161,23 +292,17 @@ Tri::Tri(Point _v0, Point _v1, Point _v2) {
 	pre[5] = _v2.x - _v0.x;
 }
 
-Point Tri::get_named_point(string name) const {
-	if(name == "c")
-		return Point((v0.x + v1.x + v2.x) / 3, (v0.y + v1.y + v2.y) / 3);
-	else if(name == "v0")
-		return v0;
-	else if(name == "v1")
-		return v1;
-	else if(name == "v2")
-		return v2;
-	else if(name == "s01")
-		return Point((v0.x + v1.x) / 2, (v0.y + v1.y) / 2);
-	else if(name == "s02")
-		return Point((v0.x + v2.x) / 2, (v0.y + v2.y) / 2);
-	else if(name == "s12")
-		return Point((v1.x + v2.x) / 2, (v1.y + v2.y) / 2);
-	else
-		throw invalid_argument("Point doesn't exist.");
+Point Tri::get_named_point(NamedPoint name) const {
+	switch(name) {
+		case PT_C: return Point((v0.x + v1.x + v2.x) / 3, (v0.y + v1.y + v2.y) / 3);
+		case PT_V0: return v0;
+		case PT_V1: return v1;
+		case PT_V2: return v2;
+		case PT_S01: return Point((v0.x + v1.x) / 2, (v0.y + v1.y) / 2);
+		case PT_S02: return Point((v0.x + v2.x) / 2, (v0.y + v2.y) / 2);
+		case PT_S12: return Point((v1.x + v2.x) / 2, (v1.y + v2.y) / 2);
+		default: throw invalid_argument("Point doesn't exist.");
+	}
 }
 
 domain Tri::get_domain() const {
@@ -199,13 +324,21 @@ bool Tri::contains(Point p) const {
 	return !(((d1 < 0) || (d2 < 0) || (d3 < 0)) && ((d1 > 0) || (d2 > 0) || (d3 > 0)));
 }
 
+size_t Tri::get_hash() const {
+	return hash_values('t', v0, v1, v2);
+}
+
+bool Tri::same(const Tri& other) const {
+	return same_bits(v0, other.v0) && same_bits(v1, other.v1) && same_bits(v2, other.v2);
+}
+
 /* Derived shapes */
 
 /*********/
 /* SHIFT */
 /*********/
 
-Point Shift::get_named_point(string name) const {
+Point Shift::get_named_point(NamedPoint name) const {
 	return (ref_shape->get_named_point(name)).shift(t);
 }
 
@@ -219,11 +352,19 @@ bool Shift::contains(Point p) const {
 	return ref_shape->contains(p.shift(t_inv));
 }
 
+size_t Shift::get_hash() const {
+	return hash_values('s', t, ref_shape);
+}
+
+bool Shift::same(const Shift& other) const {
+	return same_bits(t, other.t) && ref_shape == other.ref_shape;
+}
+
 /*******/
 /* ROT */
 /*******/
 
-Point Rot::get_named_point(string name) const {
+Point Rot::get_named_point(NamedPoint name) const {
 	return (ref_shape->get_named_point(name)).rotate(r, sin_a, cos_a);
 }
 
@@ -251,11 +392,20 @@ bool Rot::contains(Point p) const {
 	return ref_shape->contains(p.rotate(r, - sin_a, cos_a));
 }
 
+size_t Rot::get_hash() const {
+	/// The rotation is identified by its sinus and cosinus (the angle isn't kept).
+	return hash_values('o', sin_a, cos_a, r, ref_shape);
+}
+
+bool Rot::same(const Rot& other) const {
+	return same_bits(sin_a, other.sin_a) && same_bits(cos_a, other.cos_a) && same_bits(r, other.r) && ref_shape == other.ref_shape;
+}
+
 /*********/
 /* UNION */
 /*********/
 
-Point Union::get_named_point(string name) const {
+Point Union::get_named_point(NamedPoint name) const {
 	return shapes.at(0)->get_named_point(name);
 }
 
@@ -291,11 +441,24 @@ bool Union::contains(Point p) const {
 	return false;
 }
 
+size_t Union::get_hash() const {
+	uint64_t h = uint64_t('u');
+
+	for(const auto& shape : shapes)
+		mix(h, shape);
+
+	return size_t(h);
+}
+
+bool Union::same(const Union& other) const {
+	return shapes == other.shapes;
+}
+
 /********/
 /* DIFF */
 /********/
 
-Point Diff::get_named_point(string name) const {
+Point Diff::get_named_point(NamedPoint name) const {
 	return shape_in->get_named_point(name);
 }
 
@@ -306,3 +469,11 @@ domain Diff::get_domain() const {
 bool Diff::contains(Point p) const {
 	return !shape_out->contains(p) && shape_in->contains(p);
 }
+
+size_t Diff::get_hash() const {
+	return hash_values('d', shape_in, shape_out);
+}
+
+bool Diff::same(const Diff& other) const {
+	return shape_in == other.shape_in && shape_out == other.shape_out;
+}
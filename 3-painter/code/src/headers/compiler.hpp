@@ -0,0 +1,121 @@
+/**
+ * Object-oriented programming project - Project 3
+ * Drawing geometric figures
+ *
+ * @author Maxime Meurisse (m.meurisse@student.uliege.be) - 20161278
+ * @version 2019.05.15
+ */
+
+#ifndef COMPILER_HPP
+#define COMPILER_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+
+#include "parser.hpp"
+
+/**
+ * The 'Compiler' class saves a scene (cfr. 'Scene') in a compiled file,
+ * and loads it back without parsing its paint file again.
+ *
+ * A compiled file is made of :
+ * 		- a header : "PNTC", the version of the format, the hash of the paint file,
+ * 		  the size of the image, the statistics, the files of the imported modules
+ * 		  (with their hash) and the number of shapes and fills
+ * 		- the shapes : the type and the values of each shape
+ * 		  (the shapes it refers to are saved before it, and referred by their index)
+ * 		- the fills : the index of the shape to draw and the color of each fill
+ * 		- a checksum : the hash (FNV-1a, 64 bits) of all the bytes before it
+ *
+ * A module (cfr. 'Module') is saved the same way in a compiled file made of :
+ * 		- a header : "PNTM", the version of the format and the files of the module
+ * 		  (with their hash, the module first)
+ * 		- the files of the modules it imports
+ * 		- the shapes of these modules used by the module (each one with its module and its name)
+ * 		- the shapes of the module, whose indices follow the ones of the imported shapes
+ * 		- the names of the shapes and the colors of the module
+ * 		- a checksum, as for a scene
+ *
+ * The values are saved in the byte order of the machine. A compiled file whose version
+ * or hashes are not the expected ones is stale, and is not loaded. A file whose checksum
+ * or sizes are not valid is damaged, and is not loaded either.
+ */
+class Compiler {
+public:
+	/// Version of the format of the compiled files.
+	static const uint32_t VERSION = 5;
+
+	/**
+	 * Compute the hash (FNV-1a, 64 bits) of the content of a file.
+	 *
+	 * @param filename the file
+	 * @param hash the hash of the file
+	 * @return a boolean value indicating if the file could be read
+	 */
+	static bool hash_file(const std::string& filename, uint64_t& hash);
+
+	/**
+	 * Save a scene in a compiled file.
+	 *
+	 * @param filename the compiled file
+	 * @param scene the scene to save
+	 * @param source_hash the hash of the paint file of the scene
+	 * @return a boolean value indicating if the file could be written
+	 */
+	static bool save(const std::string& filename, const Scene& scene, uint64_t source_hash);
+
+	/**
+	 * Load a scene from a compiled file.
+	 *
+	 * @param filename the compiled file
+	 * @param source_hash the hash of the paint file of the scene
+	 * @param scene the loaded scene
+	 * @return a boolean value indicating if the file is valid and up to date
+	 */
+	static bool load(const std::string& filename, uint64_t source_hash, Scene& scene);
+
+	/**
+	 * Save a module in a compiled file.
+	 *
+	 * @param filename the compiled file
+	 * @param module the module to save
+	 * @return a boolean value indicating if the file could be written
+	 */
+	static bool save_module(const std::string& filename, const Module& module);
+
+	/**
+	 * Load a module from a compiled file (the modules it imports are loaded by 'Modules').
+	 *
+	 * @param filename the compiled file
+	 * @param module the loaded module, whose file is known
+	 * @return a boolean value indicating if the file is valid and up to date
+	 */
+	static bool load_module(const std::string& filename, Module& module);
+
+private:
+	/**
+	 * Save a shape, after the shapes it refers to (each shape is saved only once).
+	 *
+	 * @param s the shape
+	 * @param out the saved shapes
+	 * @param index the index of each shape already saved
+	 * @return the index of the shape
+	 */
+	static uint32_t save_shape(const Shape* s, std::string& out, std::unordered_map<const Shape*, uint32_t>& index);
+
+	/**
+	 * Load shapes (the shapes they refer to being already loaded).
+	 *
+	 * @param pos the position of the shapes in the compiled file
+	 * @param end the end of the compiled file
+	 * @param nb_nodes the number of shapes
+	 * @param nodes the shapes already loaded, followed by the loaded shapes
+	 * @return a boolean value indicating if the shapes are valid
+	 */
+	static bool load_shapes(const char*& pos, const char* end, uint32_t nb_nodes, std::vector<std::shared_ptr<Shape>>& nodes);
+};
+
+#endif
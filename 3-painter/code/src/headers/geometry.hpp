@@ -64,6 +64,32 @@ struct Point {
 	double x, y;
 };
 
+/* Named points */
+
+/***************/
+/* NAMED POINT */
+/***************/
+
+/// This enum defines the names of the named points of the shapes.
+enum NamedPoint : unsigned char {
+	NO_POINT,				/// Not a named point
+	PT_C,					/// c
+	PT_N, PT_NE, PT_E, PT_SE,	/// n, ne, e, se
+	PT_S, PT_SW, PT_W, PT_NW,	/// s, sw, w, nw
+	PT_F1, PT_F2,			/// f1, f2
+	PT_V0, PT_V1, PT_V2,	/// v0, v1, v2
+	PT_S01, PT_S02, PT_S12	/// s01, s02, s12
+};
+
+/**
+ * Return the named point whose name is 'name'.
+ *
+ * @param name the name (not null-terminated)
+ * @param length the length of the name
+ * @return the named point ('NO_POINT' if 'name' is not the name of a named point)
+ */
+NamedPoint to_named_point(const char* name, size_t length);
+
 /* Abstract shape */
 
 /*********/
@@ -78,23 +104,27 @@ typedef std::array<Point, 2> domain;
 
 class Shape {
 public:
-	Shape() : color(Color()) { }
 	virtual ~Shape() = default;
 
-	void set_color(Color c) { color = c; }
-	Color get_color() const { return color; }
-
 	/**
 	 * Return the named point 'name' of the shape.
 	 * All named points are defined in the project statement.
 	 *
+	 * @param name the name of the named point
+	 * @return a 'Point' representing the named point
+	 */
+	Point get_named_point(std::string name) const;
+
+	/**
+	 * Return the named point 'name' of the shape.
+	 *
 	 * This function is pure virtual and is redefined in all children
 	 * of this class.
 	 *
-	 * @param name the name of the named point
+	 * @param name the named point
 	 * @return a 'Point' representing the named point
 	 */
-	virtual Point get_named_point(std::string name) const = 0;
+	virtual Point get_named_point(NamedPoint name) const = 0;
 
 	/**
 	 * Return the domain of the shape, according to the representation
@@ -127,18 +157,33 @@ public:
 	 */
 	virtual bool contains(Point p) const = 0;
 
-protected:
-	/// The color of the shape (by default, default value of Color)
-	Color color;
+	/**
+	 * Return the hash of the structure of the shape : its type and its values
+	 * (the shapes it refers to being identified by their address).
+	 * Each child also has a method 'same' comparing its structure with the one of a shape
+	 * of the same type. Two shapes with the same structure are identical (cfr. 'Parser::make_shape').
+	 *
+	 * This function is pure virtual and is redefined in all children
+	 * of this class.
+	 *
+	 * @return the hash of the structure
+	 */
+	virtual size_t get_hash() const = 0;
 };
 
+/**
+ * A fill is a shape to draw with its color (the same shape can be filled with several colors).
+ */
+typedef std::pair<std::shared_ptr<Shape>, Color> Fill;
+
 /* Primitive shapes */
 
 /**
  * All the following classes have a private constructor and
  * are friend with 'Parser' class.
  *
- * Only the 'Parser' class can instantiate shapes.
+ * Only the 'Parser' class (and the 'Compiler' class, which loads
+ * compiled scenes) can instantiate shapes.
  *
  * There is therefore no need to check the validity of the arguments
  * of each method because the 'Parser' class is already taking care of it.
@@ -150,13 +195,17 @@ protected:
 
 class Elli : public Shape {
 public:
-	virtual Point get_named_point(std::string name) const override;
+	using Shape::get_named_point;
+	virtual Point get_named_point(NamedPoint name) const override;
 	domain get_domain() const override;
 	virtual bool contains(Point p) const override;
+	virtual size_t get_hash() const override;
+	bool same(const Elli& other) const;
 
 protected:
 	Elli(Point _c, double _a, double _b) : c(_c), a(_a), b(_b), a2(pow(_a, 2)), ab2(pow(_a * _b, 2)), incr(M_SQRT2 / 2), d_f(sqrt(pow(a, 2) - pow(b, 2))) { }
 	friend class Parser;
+	friend class Compiler;
 
 	/// Center point
 	Point c;
@@ -177,12 +226,14 @@ protected:
 
 class Circ : public Elli {
 public:
-	Point get_named_point(std::string name) const override;
+	using Shape::get_named_point;
+	Point get_named_point(NamedPoint name) const override;
 	bool contains(Point p) const override;
 
 private:
 	Circ(Point _c, double _radius) : Elli(_c, _radius, _radius) { }
 	friend class Parser;
+	friend class Compiler;
 };
 
 /********/
@@ -191,13 +242,17 @@ private:
 
 class Rect : public Shape {
 public:
-	Point get_named_point(std::string name) const override;
+	using Shape::get_named_point;
+	Point get_named_point(NamedPoint name) const override;
 	domain get_domain() const override;
 	bool contains(Point p) const override;
+	size_t get_hash() const override;
+	bool same(const Rect& other) const;
 
 private:
 	Rect(Point _c, double _width, double _height) : c(_c), width(_width), height(_height), mid_width(_width / 2), mid_height(_height / 2) { }
 	friend class Parser;
+	friend class Compiler;
 
 	/// Center point
 	Point c;
@@ -212,13 +267,17 @@ private:
 
 class Tri : public Shape {
 public:
-	Point get_named_point(std::string name) const override;
+	using Shape::get_named_point;
+	Point get_named_point(NamedPoint name) const override;
 	domain get_domain() const override;
 	bool contains(Point p) const override;
+	size_t get_hash() const override;
+	bool same(const Tri& other) const;
 
 private:
 	Tri(Point _v0, Point _v1, Point _v2);
 	friend class Parser;
+	friend class Compiler;
 
 	/// The three vertices of the triangle (no matter the order)
 	Point v0, v1, v2;
@@ -235,13 +294,17 @@ private:
 
 class Shift : public Shape {
 public:
-	Point get_named_point(std::string name) const override;
+	using Shape::get_named_point;
+	Point get_named_point(NamedPoint name) const override;
 	domain get_domain() const override;
 	bool contains(Point p) const override;
+	size_t get_hash() const override;
+	bool same(const Shift& other) const;
 
 private:
 	Shift(Point _t, std::shared_ptr<Shape> _ref_shape) : t(_t), t_inv(Point(- _t.x, - _t.y)), ref_shape(_ref_shape) { }
 	friend class Parser;
+	friend class Compiler;
 
 	/// Point of translation (t) and his inverse (t_inv)
 	/// Inverse point lead to the inverse translation
@@ -258,13 +321,17 @@ private:
 
 class Rot : public Shape {
 public:
-	Point get_named_point(std::string name) const override;
+	using Shape::get_named_point;
+	Point get_named_point(NamedPoint name) const override;
 	domain get_domain() const override;
 	bool contains(Point p) const override;
+	size_t get_hash() const override;
+	bool same(const Rot& other) const;
 
 private:
 	Rot(double _angle, Point _r, std::shared_ptr<Shape> _ref_shape) : sin_a(sin(_angle * M_PI / 180.0)), cos_a(cos(_angle * M_PI / 180.0)), r(_r), ref_shape(_ref_shape) { }
 	friend class Parser;
+	friend class Compiler;
 
 	/// Sinus and cosinus of the angle of rotation
 	double sin_a, cos_a;
@@ -283,13 +350,17 @@ private:
 
 class Union : public Shape {
 public:
-	Point get_named_point(std::string name) const override;
+	using Shape::get_named_point;
+	Point get_named_point(NamedPoint name) const override;
 	domain get_domain() const override;
 	bool contains(Point p) const override;
+	size_t get_hash() const override;
+	bool same(const Union& other) const;
 
 private:
 	Union(std::vector<std::shared_ptr<Shape>> _shapes) : shapes(_shapes) { }
 	friend class Parser;
+	friend class Compiler;
 
 	/// The vector of references to all shapes composing the union
 	std::vector<std::shared_ptr<Shape>> shapes;
@@ -301,13 +372,17 @@ private:
 
 class Diff : public Shape {
 public:
-	Point get_named_point(std::string name) const override;
+	using Shape::get_named_point;
+	Point get_named_point(NamedPoint name) const override;
 	domain get_domain() const override;
 	bool contains(Point p) const override;
+	size_t get_hash() const override;
+	bool same(const Diff& other) const;
 
 private:
 	Diff(std::shared_ptr<Shape> _shape_in, std::shared_ptr<Shape> _shape_out) : shape_in(_shape_in), shape_out(_shape_out) { }
 	friend class Parser;
+	friend class Compiler;
 
 	/// Reference to the shape to be substracted from (shape_in)
 	/// Reference to the shape to be substracted (shape_out)
@@ -0,0 +1,172 @@
+/**
+ * Object-oriented programming project - Project 3
+ * Drawing geometric figures
+ *
+ * @author Maxime Meurisse (m.meurisse@student.uliege.be) - 20161278
+ * @version 2019.05.15
+ */
+
+#ifndef INCREMENTAL_HPP
+#define INCREMENTAL_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "parser.hpp"
+
+/**
+ * The 'IncrementalParser' class parses a content that is edited,
+ * by parsing again only the parts of the content affected by an edit.
+ *
+ * The content is split in chunks : consecutive lines containing whole instructions
+ * (an instruction is never split between two chunks). Each chunk keeps its shapes,
+ * colors and fills, and the names it uses that are defined by previous chunks.
+ *
+ * After an edit, only the chunks containing the edited lines are converted and parsed again,
+ * as well as the following chunks that depend (directly or not) on the names they define.
+ * The other chunks are kept as they are (only their position is updated).
+ *
+ * If the content is not valid, the whole content is parsed (to get the same diagnostic
+ * as the one of 'Parser') and the next edit parses the whole content again.
+ *
+ * The shapes of a scene are shared with the next scenes, so a scene must not be used
+ * after the next edit.
+ */
+class IncrementalParser : private Scope {
+public:
+	IncrementalParser(std::string fname) : filename(fname) { }
+
+	IncrementalParser(const IncrementalParser&) = delete;
+	IncrementalParser& operator=(const IncrementalParser&) = delete;
+
+	/**
+	 * Parse a whole content (the previous content is forgotten).
+	 *
+	 * @param content the content to parse
+	 * @return the result of the parsing
+	 */
+	ParseResult parse(std::string content);
+
+	/**
+	 * Replace lines of the content and parse the content again.
+	 *
+	 * @param first_line the first line to replace (from 1)
+	 * @param nb_lines the number of lines to replace (0 to insert lines before 'first_line')
+	 * @param text the new lines (each one ending with a '\n')
+	 * @return the result of the parsing
+	 */
+	ParseResult edit(unsigned long first_line, unsigned long nb_lines, std::string text);
+
+	/**
+	 * Return the number of lines parsed by the last call to 'parse' or 'edit'.
+	 */
+	size_t get_nb_parsed_lines() const { return nb_parsed_lines; }
+
+private:
+	/**
+	 * A chunk of the content, with the results of its parsing.
+	 */
+	struct Chunk {
+		std::string text; /// the lines of the chunk
+		unsigned long first_line, nb_lines;
+		size_t index; /// the position of the chunk in the content
+
+		/// The names defined by the chunk, and the names of previous chunks it uses.
+		std::vector<std::string> shapes, colors;
+		std::vector<std::string> used_shapes, used_colors;
+
+		/// The fills of the chunk (each shape with its color).
+		std::vector<Fill> fills;
+
+		/// The shapes made by the chunk (cfr. 'Parser::make_shape').
+		std::vector<const Shape*> nodes;
+
+		/// The modules imported by the chunk.
+		std::vector<std::shared_ptr<const Module>> imports;
+	};
+
+	/// A shape (or a color) with the chunk that defines it.
+	struct ShapeDef {
+		Chunk* chunk;
+		std::shared_ptr<Shape> shape;
+	};
+
+	struct ColorDef {
+		Chunk* chunk;
+		Color color;
+	};
+
+	std::string filename;
+
+	/// The chunks of the content (when it is valid), or the content (when it isn't).
+	std::vector<std::unique_ptr<Chunk>> chunks;
+	std::string invalid_content;
+	bool valid = false;
+
+	/// The names defined by all the chunks, and the chunks that use each name.
+	std::unordered_map<std::string, ShapeDef> shapes;
+	std::unordered_map<std::string, ColorDef> colors;
+	std::unordered_map<std::string, std::unordered_set<Chunk*>> shape_users, color_users;
+
+	/// The shapes made by all the chunks (cfr. 'Parser::make_shape'), shared by the parsers
+	/// of the chunks so that identical shapes are shared as in a whole parsing
+	/// (they are also shared in large contents, cfr. 'Parser::make_shape').
+	/// Each shape is counted once per chunk that made it : a shape made by no chunk
+	/// anymore is removed, and the number of shapes identical to a previous one is
+	/// the number of shapes made minus the number of different shapes.
+	std::unordered_multimap<size_t, std::shared_ptr<Shape>> nodes;
+	std::unordered_map<const Shape*, size_t> node_uses;
+	size_t nb_made = 0;
+
+	/// The chunk being parsed (only the names of previous chunks can be used).
+	Chunk* current = nullptr;
+
+	size_t width = 0, height = 0;
+	size_t nb_parsed_lines = 0;
+
+	/**
+	 * Parse lines of the content and split them in chunks.
+	 * The names of the chunks are added to the names of the content.
+	 *
+	 * @param text the lines to parse
+	 * @param first_line the number of the first line
+	 * @param index the position of the first chunk
+	 * @param out the chunks of the lines
+	 * @return a boolean value indicating if the lines are valid
+	 */
+	bool parse_chunks(const std::string& text, unsigned long first_line, size_t index, std::vector<std::unique_ptr<Chunk>>& out);
+
+	/**
+	 * Remove the names defined and used by a chunk.
+	 *
+	 * @param chunk the chunk
+	 */
+	void forget(Chunk* chunk);
+
+	/**
+	 * Parse a whole content from scratch (cfr. 'parse').
+	 *
+	 * @param content the content
+	 * @return the result of the parsing
+	 */
+	ParseResult parse_all(std::string content);
+
+	/**
+	 * Build the result of the parsing from the chunks.
+	 *
+	 * @return the result of the parsing
+	 */
+	ParseResult get_result() const;
+
+	/* Scope */
+
+	std::shared_ptr<Shape> find_shape(const std::string& name) override;
+	bool find_color(const std::string& name, Color& c) override;
+	bool has_shape(const std::string& name) const override;
+	bool has_color(const std::string& name) const override;
+};
+
+#endif
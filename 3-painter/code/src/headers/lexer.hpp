@@ -0,0 +1,314 @@
+/**
+ * Object-oriented programming project - Project 3
+ * Drawing geometric figures
+ *
+ * @author Maxime Meurisse (m.meurisse@student.uliege.be) - 20161278
+ * @version 2019.05.15
+ */
+
+#ifndef LEXER_HH
+#define LEXER_HH
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/// This enum defines the different possible types of a token.
+enum type : unsigned int {
+	END,			/// End of file
+	STRING,			/// fig_circle, x
+	NUMBER,			/// +3, .4, 5.0, -1.
+	POINT,			/// .
+	OPEN_BRACE,		/// {
+	CLOSE_BRACE,	/// }
+	OPEN_PAR,		/// (
+	CLOSE_PAR,		/// )
+	OPERATOR,		/// +, -, *, /
+	PATH			/// "shapes.paint"
+};
+
+/// This enum defines the keywords of the paint language.
+enum keyword : unsigned char {
+	NO_KEYWORD,		/// Not a keyword
+	KW_SIZE,		/// size
+	KW_CIRC,		/// circ
+	KW_ELLI,		/// elli
+	KW_RECT,		/// rect
+	KW_TRI,			/// tri
+	KW_SHIFT,		/// shift
+	KW_ROT,			/// rot
+	KW_UNION,		/// union
+	KW_DIFF,		/// diff
+	KW_COLOR,		/// color
+	KW_FILL,		/// fill
+	KW_IMPORT		/// import
+};
+
+/**
+ * A token is an element of the file that is defined by
+ * its position in the file ('line' and 'col'),
+ * its type (cfr. enum 'type')
+ * and its content, as a view ('offset' and 'length') into the mapped file.
+ *
+ * The content of a string token is also interned when it is a keyword (cfr. enum 'keyword')
+ * or the name of a named point (cfr. enum 'NamedPoint'), so that it is never compared again.
+ */
+struct token {
+	unsigned long line, col;
+	unsigned int type;
+	size_t offset, length;
+	unsigned char keyword, point;
+};
+
+/**
+ * The 'Lexer' class converts the content of a file into tokens.
+ * The file is mapped in memory and the tokens only refer to its bytes (no copy is made).
+ *
+ * The tokens are produced on demand, a few at a time, so that the whole file never
+ * has to be converted at once. If an invalid element is found, the conversion stops
+ * and the error is kept (it is reported by the parser).
+ */
+class Lexer {
+	friend class TokenStream;
+
+public:
+	Lexer() { }
+	~Lexer();
+
+	Lexer(const Lexer&) = delete;
+	Lexer& operator=(const Lexer&) = delete;
+
+	/**
+	 * Map the file 'filename' in memory.
+	 *
+	 * @param filename the file to convert
+	 * @return a boolean value indicating if the file could be opened
+	 */
+	bool open(const std::string& filename);
+
+	/**
+	 * Use a buffer as the content to convert (the buffer is not copied,
+	 * so it must exist as long as the lexer and its tokens).
+	 *
+	 * @param buffer the content to convert
+	 * @param size the size of the content
+	 * @param first_line the number of the first line of the content
+	 */
+	void open_buffer(const char* buffer, size_t size, unsigned long first_line = 1);
+
+	/**
+	 * Convert the next part of the file into tokens.
+	 * The last token of the file is always a "END" token.
+	 *
+	 * @param out the array where the tokens are written
+	 * @param max the size of the array (at least 3)
+	 * @return the number of tokens written (0 if the whole file is converted, or if an error occurred)
+	 */
+	size_t read(token* out, size_t max);
+
+	/**
+	 * Get the content of a token.
+	 *
+	 * @param t the token
+	 * @return the content of the token ("END" for the end of the file)
+	 */
+	std::string get_content(const token& t) const;
+
+	/**
+	 * Get the value of a number token (the same value as the one of 'atof').
+	 *
+	 * @param t the number token
+	 * @return the value of the token
+	 */
+	double get_number(const token& t) const;
+
+	size_t get_size() const { return data_size; }
+
+	bool failed() const { return error; }
+	const token& get_error_token() const { return error_token; }
+	const std::string& get_error_message() const { return error_message; }
+
+private:
+	/// The content of the file, mapped in memory (or the content of a buffer).
+	const char* data = nullptr;
+	size_t data_size = 0;
+	bool mapped = false;
+
+	/// Position of the conversion : the next char to read, the end of its line,
+	/// and the buffer of the token being read (always a sequence of consecutive chars of the file).
+	size_t pos = 0, line_end = 0, begin = 0, length = 0;
+
+	/// Classes of the chars of the buffer (cfr. 'CHAR_CLASSES'), and its number of signs and points.
+	unsigned char classes = 0;
+	size_t nb_signs = 0, nb_points = 0;
+	unsigned long line = 0, col = 0;
+	bool in_line = false, finished = false;
+
+	/// Type of the last token produced ('END' if there is none), and a boolean value
+	/// indicating if it was needed before any token was produced (cfr. 'TokenStream').
+	unsigned int last_type = END;
+	bool context = false;
+
+	/// The tokens produced by the current call to 'read'.
+	token* out = nullptr;
+	size_t out_count = 0;
+
+	/// The error that stopped the conversion (if any).
+	bool error = false;
+	token error_token;
+	std::string error_message;
+
+	/**
+	 * Convert the next char of the file (or go to the next line).
+	 */
+	void step();
+
+	/**
+	 * Create a token from the buffer by determining its type based on its content.
+	 * If the content is not valid, the error is kept and the conversion stops.
+	 *
+	 * @param t the created token (whose type is 'END' if the buffer is empty)
+	 * @return a boolean value indicating if the content of the token is valid
+	 */
+	bool create_token(token& t);
+
+	/**
+	 * Produce a token. It also flushes the buffer.
+	 *
+	 * @param t the token to produce
+	 */
+	void push_token(const token& t);
+
+	/**
+	 * Produce a token of a given type from the buffer. It also flushes the buffer.
+	 *
+	 * @param type the type of the token
+	 */
+	void push_token(unsigned int type);
+
+	/**
+	 * Produce the token of the buffer (if it is not empty).
+	 */
+	void flush();
+
+	/**
+	 * Add the char at position 'i' to the buffer.
+	 *
+	 * @param i the position of the char in the file
+	 */
+	void append(size_t i);
+};
+
+/**
+ * The 'TokenStream' class provides the tokens of a 'Lexer' by blocks,
+ * so that only a few tokens exist at the same time.
+ *
+ * For large files, the tokens can be produced by other threads while they are parsed.
+ * As no token is split between two lines, the file is cut in parts made of whole lines,
+ * which are converted at the same time (each one by a copy of the lexer) and given in order.
+ * Only a few parts are converted in advance.
+ *
+ * The lines of a part are counted from its beginning, and are fixed when it is given.
+ * The conversion of a '.' may depend on the type of the token before the part (cfr. 'Lexer::step'):
+ * a part which needed it is converted again if the actual type is not the one supposed.
+ * The error of a part is the error of the file if the previous parts have no error.
+ */
+class TokenStream {
+public:
+	/// Number of tokens of a block (when the tokens are produced by the same thread).
+	static const size_t BLOCK_SIZE = 1024;
+
+	/// Size of a part of the file (before it is cut at the end of a line),
+	/// and minimum number of parts that can be converted in advance.
+	static const size_t PART_SIZE = 256 << 10;
+	static const size_t QUEUE_SIZE = 8;
+
+	TokenStream(Lexer& l) : lexer(l) { }
+	~TokenStream();
+
+	TokenStream(const TokenStream&) = delete;
+	TokenStream& operator=(const TokenStream&) = delete;
+
+	/**
+	 * Start the conversion of the file.
+	 *
+	 * @param threads the number of threads converting the parts of the file
+	 * (0 if the tokens are produced by the same thread)
+	 */
+	void start(unsigned int threads);
+
+	/**
+	 * Get the next block of tokens.
+	 *
+	 * @param block the block of tokens
+	 * @return a boolean value indicating if there were tokens left
+	 */
+	bool fill(std::vector<token>& block);
+
+	/**
+	 * Convert the rest of the file (the tokens are discarded), so that
+	 * the lexer either reaches the end of the file or finds an error.
+	 */
+	void drain();
+
+private:
+	/**
+	 * A part of the file, converted into tokens independently of the rest of the file.
+	 */
+	struct Part {
+		size_t begin, end; /// position of the part in the file
+		bool done = false;
+
+		std::vector<token> tokens; /// tokens of the part ("END" excluded)
+		unsigned long nb_lines = 0;
+
+		unsigned int last_type = END; /// type of the last token ('END' if there is none)
+		bool context = false; /// the type of the token before the part was needed
+
+		bool error = false;
+		token error_token;
+		std::string error_message;
+	};
+
+	Lexer& lexer;
+
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable not_empty, not_full;
+	bool started = false, threaded = false, finished = false, stop = false;
+
+	/// The parts being converted (the first one is the next part to give).
+	std::deque<Part> parts;
+	size_t nb_parts = 0, next_part = 0, first_part = 0, max_parts = 0;
+
+	/// Number of lines and type of the last token of the parts already given.
+	unsigned long nb_lines = 0;
+	unsigned int last_type = END;
+
+	/**
+	 * Return the beginning of the part 'k' of the file
+	 * (the beginning of the first line after the position 'k' * 'PART_SIZE').
+	 *
+	 * @param k the index of the part
+	 * @return the position of the beginning of the part
+	 */
+	size_t part_begin(size_t k) const;
+
+	/**
+	 * Convert a part of the file into tokens.
+	 *
+	 * @param part the part to convert
+	 * @param last the type of the token before the part
+	 */
+	void convert(Part& part, unsigned int last) const;
+
+	/**
+	 * Convert the parts of the file (in another thread).
+	 */
+	void produce();
+};
+
+#endif
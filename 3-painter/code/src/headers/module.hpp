@@ -0,0 +1,94 @@
+/**
+ * Object-oriented programming project - Project 3
+ * Drawing geometric figures
+ *
+ * @author Maxime Meurisse (m.meurisse@student.uliege.be) - 20161278
+ * @version 2019.05.15
+ */
+
+#ifndef MODULE_HPP
+#define MODULE_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <map>
+#include <set>
+#include <mutex>
+#include <cstdint>
+
+#include "parser.hpp"
+
+/**
+ * A 'Module' is a paint file imported by another one ('import "file.paint"') :
+ * the shapes and colors it defines or imports, by name.
+ *
+ * A module has no 'size' instruction, and its fills are not drawn.
+ */
+struct Module {
+	std::string filename; /// the real path of the file
+
+	std::map<std::string, std::shared_ptr<Shape>> shapes;
+	std::map<std::string, Color> colors;
+
+	/// The modules imported by the module, and the files its content depends on
+	/// (the module and the modules it imports, directly or not) with the hash of their content.
+	std::vector<std::shared_ptr<const Module>> imports;
+	std::vector<std::pair<std::string, uint64_t>> files;
+};
+
+/**
+ * The 'Modules' class loads each module only once per process : a module is kept in memory,
+ * and is loaded from its compiled file ('.paintm', cfr. 'Compiler') if the hashes of its files
+ * are still the same. Otherwise, the module is parsed and its compiled file is written (if possible).
+ *
+ * The shapes of a module are shared by all the contents importing it (they are never modified).
+ * The modules can be loaded by several threads : the loads are done one at a time.
+ */
+class Modules {
+public:
+	/// Extension of the compiled files of the modules.
+	static const std::string COMPILED_EXT;
+
+	/**
+	 * Load a module.
+	 *
+	 * @param filename the file of the module
+	 * @param error the diagnostic of the module (if it can't be loaded)
+	 * @return the module (nullptr if it can't be loaded)
+	 */
+	static std::shared_ptr<const Module> load(const std::string& filename, Diagnostic& error);
+
+	/**
+	 * Add the files of a module to a list of files (each file only once).
+	 *
+	 * @param files the list of files, with the hash of their content
+	 * @param module the module
+	 */
+	static void add_files(std::vector<std::pair<std::string, uint64_t>>& files, const Module& module);
+
+	/**
+	 * Forget the modules loaded (the next loads use the compiled files, or parse the modules).
+	 */
+	static void clear();
+
+private:
+	/// The modules loaded (by real path), and the modules being parsed (to find the cycles of imports).
+	static std::map<std::string, std::shared_ptr<const Module>> loaded;
+	static std::set<std::string> loading;
+
+	/// Lock of 'loaded' and 'loading', held during a whole load (a load loads the imports of the module).
+	static std::recursive_mutex lock;
+
+	/**
+	 * Parse a module (and its imports).
+	 *
+	 * @param module the module, whose file is known
+	 * @param filename the file of the module (as it is imported, for the diagnostic)
+	 * @param error the diagnostic of the module (if it is not valid)
+	 * @return a boolean value indicating if the module is valid
+	 */
+	static bool parse(Module& module, const std::string& filename, Diagnostic& error);
+};
+
+#endif
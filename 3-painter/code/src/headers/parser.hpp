@@ -15,56 +15,141 @@
 #include <memory>
 #include <array>
 #include <map>
+#include <unordered_map>
+#include <exception>
+#include <cstdint>
 
 #include "geometry.hpp"
 #include "graphics.hpp"
+#include "lexer.hpp"
 
-/// This enum defines the different possible types of a token.
-enum type : unsigned int {
-	END,			/// End of file
-	STRING,			/// fig_circle, x
-	NUMBER,			/// +3, .4, 5.0, -1.
-	POINT,			/// .
-	OPEN_BRACE,		/// {
-	CLOSE_BRACE,	/// }
-	OPEN_PAR,		/// (
-	CLOSE_PAR,		/// )
-	OPERATOR		/// +, -, *, /
+/**
+ * A 'Diagnostic' describes the error that makes a content invalid :
+ * its position ('line' and 'col', both 0 if the error is not in the content)
+ * and its message.
+ */
+struct Diagnostic {
+	std::string source; /// the file (or the name of the buffer) of the content
+	unsigned long line, col;
+	std::string message;
+
+	/**
+	 * Format the diagnostic according to the project guidelines.
+	 *
+	 * @return the formatted diagnostic
+	 */
+	std::string str() const;
 };
 
 /**
- * A token is an element of the file that is defined by
- * its position in the file ('line' and 'col'),
- * its type (cfr. enum 'type')
- * and its 'content'.
+ * A 'Scene' is the result of the parsing of a valid content :
+ * the size of the image and the shapes to draw,
+ * with the number of shapes and colors defined
+ * and the number of shapes identical to a previous one (cfr. 'Parser::make_shape').
+ *
+ * The files of the modules imported by the content (directly or not) are kept
+ * with the hash of their content (cfr. 'Module').
  */
-struct token {
-	unsigned long line, col;
-	unsigned int type;
-	std::string content;
+struct Scene {
+	size_t width, height;
+	std::vector<Fill> fills;
+	size_t nb_shapes, nb_colors, nb_shared;
+	std::vector<std::pair<std::string, uint64_t>> imports;
+
+	/**
+	 * Print is the 'stdout' the statistics of the scene (cfr. 'Parser::print_stats').
+	 */
+	void print_stats() const;
+};
+
+/**
+ * A 'ParseResult' is the scene of the content if it is valid ('valid' is true),
+ * or the diagnostic of its error otherwise.
+ */
+struct ParseResult {
+	bool valid;
+	Scene scene;
+	Diagnostic error;
+};
+
+/**
+ * A 'Scope' provides the shapes and colors defined outside of the content
+ * being parsed (cfr. 'IncrementalParser'). The names of the content are looked
+ * up in the scope when they are not defined in the content.
+ */
+class Scope {
+public:
+	virtual ~Scope() = default;
+
+	/**
+	 * Return the shape 'name' defined before the content.
+	 *
+	 * @param name the name of the shape
+	 * @return the shape (nullptr if there is none)
+	 */
+	virtual std::shared_ptr<Shape> find_shape(const std::string& name) = 0;
+
+	/**
+	 * Get the color 'name' defined before the content.
+	 *
+	 * @param name the name of the color
+	 * @param c the color
+	 * @return a boolean value indicating if the color exists
+	 */
+	virtual bool find_color(const std::string& name, Color& c) = 0;
+
+	/**
+	 * Return a boolean value indicating if a shape (or a color) 'name'
+	 * is defined outside of the content (before or after it).
+	 */
+	virtual bool has_shape(const std::string& name) const = 0;
+	virtual bool has_color(const std::string& name) const = 0;
 };
 
+struct Module;
+
 /**
- * The 'Parser' class parses the contents of a file.
+ * The 'Parser' class parses the contents of a file (or of a buffer).
  * The file to be parsed is informed to the class during its instantiation.
  *
- * First, the parser takes care of converting all the content of the file into tokens.
- * Secondly, the tokens are traversed sequentially and parsed with the proper instructions.
+ * The tokens of the file (cfr. 'Lexer') are parsed with the proper instructions
+ * as soon as they are produced, so that the tokens of the whole file never exist at the same time.
+ * For large files, the tokens are produced by other threads while they are parsed.
+ *
+ * If an error occurs, the parsing stops and the error is returned (cfr. 'ParseResult'):
+ * nothing is displayed and the program goes on, so that a program can parse many contents.
+ * A parser parses only one content.
  *
- * If an error occurs, it is displayed in the 'stderr' and the program stops.
+ * The shapes and colors of the modules imported by the content ('import "file.paint"')
+ * are defined at the position of the import (cfr. 'Modules').
  */
 class Parser {
+	friend class IncrementalParser;
+	friend class Modules;
+
 public:
-	[[noreturn]] Parser();
-	Parser(std::string fname);
+	Parser() { }
+	Parser(std::string fname) : filename(fname) { }
+
+	Parser(const Parser&) = delete;
+	Parser& operator=(const Parser&) = delete;
 
 	/**
-	 * Parse the file 'filename'.
-	 * It does this in 2 operations :
-	 * 		1. convert all the content of the file into tokens;
-	 * 		2. parse the file with the proper instructions (size first, and then the rest).
+	 * Parse the file 'filename' with the proper instructions
+	 * (size first, and then the rest).
+	 *
+	 * @return the result of the parsing
+	 */
+	ParseResult parse_file();
+
+	/**
+	 * Parse a content in memory with the proper instructions.
+	 * The name of the parser (cfr. 'filename') is used in the diagnostic.
+	 *
+	 * @param content the content to parse
+	 * @return the result of the parsing
 	 */
-	void parse_file();
+	ParseResult parse_buffer(std::string content);
 
 	/**
 	 * Print is the 'stdout' the statistics of the parsing.
@@ -72,27 +157,58 @@ public:
 	 * 		- the number of shapes defined
 	 * 		- the number of colors defined
 	 * 		- the number of fill operations used
+	 * 		- the number of shapes deduplicated (cfr. 'make_shape')
 	 */
 	void print_stats() const;
 
+	/**
+	 * Set the scope of the names that are not defined in the content.
+	 *
+	 * @param s the scope (nullptr if there is none)
+	 */
+	void set_scope(Scope* s) { scope = s; }
+
 	size_t get_width() const { return size_t(width); }
 	size_t get_height() const { return size_t(height); }
-	std::vector<std::shared_ptr<Shape>> get_fills() const { return fills; }
+	std::vector<Fill> get_fills() const { return fills; }
 
 private:
-	/// Array of special chars in the paint file.
-	const std::array<char, 6> SPECIAL_CHARS {{'{', '}', '(', ')', '*', '/'}};
+	/// Exception used to stop the parsing at the first error (it never leaves the parser).
+	struct ParseError : public std::exception {
+		ParseError(const Diagnostic& d) : diagnostic(d) { }
+
+		Diagnostic diagnostic;
+	};
+
+	/// Size of the files whose tokens are produced by other threads (4 MiB).
+	static const size_t THREADED_SIZE = 4 << 20;
+
+	/// Size of the contents whose identical shapes are shared (1 MiB, cfr. 'make_shape').
+	static const size_t SHARED_SIZE = 1 << 20;
 
 	std::string filename; /// the file that the parser parse
-	std::vector<token> file_content; /// the content of the file, converted to tokens (always ending by a "END" token)
+	std::string buffer; /// the content that the parser parse (if it is not a file)
+
+	/// The tokens of the file, and the block of tokens being parsed.
+	Lexer lexer;
+	TokenStream stream{lexer};
 
-	/// Informations about the 'file_content' for 'next_token' method.
-	unsigned long file_content_pos = 0;
-	unsigned long file_content_size;
+	std::vector<token> block;
+	size_t block_pos = 0;
 
-	/// Informations about the position of the current token.
+	/// Informations about the position of the current token
+	/// (and the line of the last token that is not only read ahead).
 	unsigned long actual_line = 0;
 	unsigned long actual_col = 0;
+	unsigned long last_line = 0;
+
+	/// The scope of the names that are not defined in the content (if any).
+	Scope* scope = nullptr;
+
+	/// Informations about the modules : the content is a module (without size),
+	/// and the modules imported by the content.
+	bool is_module = false;
+	std::vector<std::shared_ptr<const Module>> imports;
 
 	/// Informations about shapes and color declared in the paint file.
 	std::map<std::string, std::shared_ptr<Shape>> shapes;
@@ -101,59 +217,47 @@ private:
 	std::map<std::string, Color> colors;
 	std::map<std::string, std::pair<unsigned long, unsigned long>> colors_name;
 
+	/// The shapes created, by hash of their structure (cfr. 'Shape::get_hash'),
+	/// and the number of shapes identical to a shape already created.
+	/// The shapes are kept only if they are shared (cfr. 'make_shape').
+	bool sharing = false;
+	std::unordered_multimap<size_t, std::shared_ptr<Shape>> nodes;
+	size_t nb_shared = 0;
+
+	/// If it is set, the shapes returned by 'make_shape' are also added to 'made' (cfr. 'IncrementalParser').
+	std::vector<const Shape*>* made = nullptr;
+
 	/// Final informations to provide to create the PPM image.
 	double width, height;
-	std::vector<std::shared_ptr<Shape>> fills;
+	std::vector<Fill> fills;
 
-	/****************************/
-	/* Token conversion methods */
-	/****************************/
+	/************************/
+	/* Token access methods */
+	/************************/
 
 	/**
-	 * Create a token by determining its type based on its content.
+	 * Return the next token of the file.
+	 * Depending on the value of 'incr', the next token that will be return at next call is the same or the next.
 	 *
-	 * @param line the line of the token
-	 * @param col the col of the token
-	 * @param content the content of the token
-	 * @param file the file to close if an error occured
-	 * @return a token whose type has been determined according to its content
+	 * @param incr an increment value that determines the next token that will be return at next call
+	 * @return the next token of the file
 	 */
-	token create_token(unsigned long line, unsigned long col, std::string content, std::ifstream& file) const;
+	token next_token(const unsigned long& incr);
 
 	/**
-	 * Create a token.
+	 * Parse the content of the lexer and build the result of the parsing.
 	 *
-	 * @param line the line of the token
-	 * @param col the col of the token
-	 * @param type the type of the token
-	 * @param content the content of the token
-	 * @return the created token
+	 * @return the result of the parsing
 	 */
-	token create_token(unsigned long line, unsigned long col, unsigned int type, std::string content) const;
+	ParseResult parse_content();
 
 	/**
-	 * Push the token in the 'file_content' vector.
-	 * It also flushes the buffer.
-	 * If the buffer is empty, it means that the token is empty too (no content, unknown type), so we don't push.
+	 * Get the content of a token.
 	 *
-	 * @param t the token to push
-	 * @param buffer the buffer containing the content of the token
-	 */
-	void push_token(token t, std::string& buffer);
-
-	/**
-	 * Convert the content of the file 'filename' to tokens and store it in 'file_content'.
+	 * @param t the token
+	 * @return the content of the token
 	 */
-	void convert_token();
-
-	/**
-	 * Return a token of the 'file_content' vector.
-	 * Depending on the value of 'incr', the next token that will be return at next call is the same or the next.
-	 *
-	 * @param incr an increment value that determines the next token that will be return at next call
-	 * @return a token of the 'file_content' vector
-	 */
-	token next_token(const unsigned long& incr);
+	std::string get_content(const token& t) const;
 
 	/*******************/
 	/* Parsing methods */
@@ -167,6 +271,7 @@ private:
 	 */
 
 	void parse_instr();
+	void parse_statement(const token& keyword);
 
 	void parse_size();
 
@@ -184,6 +289,35 @@ private:
 	void parse_color();
 	void parse_fill();
 
+	void parse_import();
+
+	/**
+	 * These instructions are used to define a name (which must not be already defined)
+	 * and to find the shape or the color of a name (in the content, then in the scope).
+	 */
+
+	void define_shape(const std::string& name);
+	void define_color(const std::string& name);
+
+	/**
+	 * Return the shape already created with the same structure as 'shape'
+	 * (cfr. 'Shape::get_hash'), or a new copy of 'shape' otherwise.
+	 * Identical shapes are thus created only once, and shared by their names
+	 * (the colors are kept by the fills, cfr. 'Fill').
+	 *
+	 * The shapes are shared only in the contents smaller than 'SHARED_SIZE' (or if 'sharing'
+	 * is set, cfr. 'IncrementalParser') : the shapes of larger contents (mostly generated)
+	 * are rarely identical, and keeping all of them would slow down the parsing.
+	 *
+	 * @param shape the shape
+	 * @return the shape of the structure
+	 */
+	template<typename T>
+	std::shared_ptr<Shape> make_shape(const T& shape);
+
+	std::shared_ptr<Shape> find_shape(const std::string& name);
+	bool find_color(const std::string& name, Color& c);
+
 	std::string parse_name();
 
 	double parse_number();
@@ -194,34 +328,29 @@ private:
 	/***************************/
 
 	/**
-	 * Print a message in the stderr with information about the wrong token,
+	 * Stop the parsing with an error about the wrong token,
 	 * according to the format explained in the project guidelines.
 	 *
+	 * An error of the lexer (even further in the file) is always reported first,
+	 * so the rest of the file is converted before.
+	 *
 	 * @param t the wrong token
-	 * @param msg the msg to print in the stderr
+	 * @param msg the message of the error
 	 */
-	[[noreturn]] void print_error(const token& t, const std::string& msg) const;
+	[[noreturn]] void raise_error(const token& t, const std::string& msg);
 
 	/**
-	 * Print a message in the stderr with information about the wrong token,
+	 * Stop the parsing with an error about the current token,
 	 * according to the format explained in the project guidelines.
 	 *
-	 * @param msg the msg to print in the stderr
+	 * @param msg the message of the error
 	 */
-	[[noreturn]] void print_error(const std::string& msg) const;
-
-	/*******************/
-	/* Utility methods */
-	/*******************/
+	[[noreturn]] void raise_error(const std::string& msg);
 
 	/**
-	 * Check if a given char is in an array of chars.
-	 *
-	 * @param a the array of chars
-	 * @param c the char
-	 * @return a boolean value indicating if the char 'c' is in the array of chars 'a'
+	 * Stop the parsing with the error of the lexer.
 	 */
-	bool is_in(const std::array<char, 6>& a, const char& c) const;
+	[[noreturn]] void raise_lexer_error() const;
 };
 
 #endif
@@ -0,0 +1,75 @@
+/**
+ * Object-oriented programming project - Project 3
+ * Drawing geometric figures
+ *
+ * @author Maxime Meurisse (m.meurisse@student.uliege.be) - 20161278
+ * @version 2019.05.15
+ */
+
+#ifndef RENDERER_HPP
+#define RENDERER_HPP
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <atomic>
+
+#include "geometry.hpp"
+#include "graphics.hpp"
+
+/**
+ * The 'Renderer' class draws the fills of a scene in an image.
+ *
+ * A pixel takes the color of the last fill containing its center : the fills are checked
+ * in reverse order, and the first one containing the pixel sets it.
+ *
+ * The image is cut in square tiles, in bands (rows of tiles). The fills whose domain intersects
+ * a band are listed in reverse order, only while the tiles of the band are drawn, so that the memory
+ * used doesn't depend on the number of tiles. The tiles are drawn by several threads, in order
+ * (each tile by one thread, the tiles of a band by several threads and the next bands as soon
+ * as a thread is free), and a tile is done as soon as all its pixels are set.
+ * As each pixel is still set by the same fill, the image is the same whatever the number of threads.
+ */
+class Renderer {
+public:
+	/// Size (in pixels) of the side of a tile.
+	static const size_t TILE_SIZE = 64;
+
+	/**
+	 * Draw fills in an image (whose pixels are not set yet).
+	 *
+	 * @param img the image
+	 * @param fills the shapes to draw with their colors, in the order of the fills
+	 * @param threads the number of threads drawing the tiles (0 for the number of cores)
+	 */
+	static void draw(Image& img, const std::vector<Fill>& fills, unsigned int threads = 0);
+
+private:
+	/**
+	 * The part of the image drawn for a fill (its domain, limited to the image).
+	 */
+	struct Area {
+		size_t x_min, x_max, y_min, y_max; /// 'x_max' and 'y_max' excluded
+	};
+
+	/**
+	 * The fills intersecting a band (in reverse order), and the number of its tiles not drawn yet.
+	 */
+	struct Band {
+		std::vector<uint32_t> fills;
+		std::atomic<size_t> nb_left;
+	};
+
+	/**
+	 * Draw the fills intersecting a tile.
+	 *
+	 * @param img the image
+	 * @param fills the shapes to draw with their colors
+	 * @param areas the areas of the shapes
+	 * @param band the indices of the fills intersecting the band of the tile, in reverse order
+	 * @param tile the area of the tile
+	 */
+	static void draw_tile(Image& img, const std::vector<Fill>& fills, const std::vector<Area>& areas, const std::vector<uint32_t>& band, const Area& tile);
+};
+
+#endif
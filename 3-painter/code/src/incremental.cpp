@@ -0,0 +1,478 @@
+/**
+ * Object-oriented programming project - Project 3
+ * Drawing geometric figures
+ *
+ * @author Maxime Meurisse (m.meurisse@student.uliege.be) - 20161278
+ * @version 2019.05.15
+ */
+
+#include <algorithm>
+#include <cstdint>
+
+#include "headers/incremental.hpp"
+#include "headers/module.hpp"
+
+using namespace std;
+
+/**
+ * Return the position of the beginning of a line of a text
+ * (the size of the text if the text has less lines).
+ *
+ * @param text the text
+ * @param line the line (from 0)
+ * @return the position of the line
+ */
+static size_t line_offset(const string& text, unsigned long line) {
+	size_t pos = 0;
+
+	for(; line > 0 && pos < text.size(); line--) {
+		size_t eol = text.find('\n', pos);
+
+		if(eol == string::npos)
+			return text.size();
+
+		pos = eol + 1;
+	}
+
+	return pos;
+}
+
+/**
+ * Return the number of lines of a text.
+ *
+ * @param text the text
+ * @return the number of lines
+ */
+static unsigned long count_lines(const string& text) {
+	unsigned long nb = (unsigned long) count(text.begin(), text.end(), '\n');
+
+	if(!text.empty() && text.back() != '\n')
+		nb++;
+
+	return nb;
+}
+
+/**
+ * Replace lines of a text.
+ *
+ * @param content the text
+ * @param first the first line to replace (from 0)
+ * @param nb the number of lines to replace
+ * @param text the new lines
+ */
+static void replace_lines(string& content, unsigned long first, unsigned long nb, const string& text) {
+	size_t begin = line_offset(content, first);
+
+	/// The last line of the content may not end with a '\n'.
+	if(begin == content.size() && !content.empty() && content.back() != '\n' && !text.empty()) {
+		content += '\n';
+		begin = content.size();
+	}
+
+	content.replace(begin, line_offset(content, first + nb) - begin, text);
+}
+
+/* Public methods */
+
+ParseResult IncrementalParser::parse(string content) {
+	return parse_all(move(content));
+}
+
+ParseResult IncrementalParser::edit(unsigned long first_line, unsigned long nb_lines, string text) {
+	if(!text.empty() && text.back() != '\n')
+		text += '\n';
+
+	first_line = max(first_line, 1ul);
+
+	if(!valid) {
+		replace_lines(invalid_content, first_line - 1, nb_lines, text);
+
+		return parse_all(move(invalid_content));
+	}
+
+	/// The chunks containing the edited lines (or the last chunk, if the lines are added at the end).
+	const Chunk& last = *chunks.back();
+	unsigned long nb_total = last.first_line + last.nb_lines - 1;
+
+	first_line = min(first_line, nb_total + 1);
+	nb_lines = min(nb_lines, nb_total + 1 - first_line);
+
+	auto chunk_of = [this](unsigned long line) {
+		auto it = upper_bound(chunks.begin(), chunks.end(), line, [](unsigned long l, const unique_ptr<Chunk>& c) {
+			return l < c->first_line;
+		});
+
+		return size_t(it - chunks.begin()) - 1;
+	};
+
+	size_t a = chunk_of(min(first_line, nb_total));
+	size_t b = chunk_of(min(max(first_line + nb_lines, first_line + 1) - 1, nb_total)) + 1;
+
+	unsigned long region_line = chunks[a]->first_line;
+	string region;
+
+	for(size_t i = a; i < b; i++)
+		region += chunks[i]->text;
+
+	replace_lines(region, first_line - region_line, nb_lines, text);
+
+	long delta = long(count_lines(text)) - long(nb_lines);
+
+	/// The names defined by the edited chunks are forgotten, and the following chunks
+	/// are hidden while the new chunks are parsed.
+	unordered_set<string> dirty_shapes, dirty_colors;
+
+	for(size_t i = a; i < b; i++) {
+		forget(chunks[i].get());
+
+		dirty_shapes.insert(chunks[i]->shapes.begin(), chunks[i]->shapes.end());
+		dirty_colors.insert(chunks[i]->colors.begin(), chunks[i]->colors.end());
+	}
+
+	chunks.erase(chunks.begin() + long(a), chunks.begin() + long(b));
+
+	for(size_t i = a; i < chunks.size(); i++)
+		chunks[i]->index = SIZE_MAX / 2 + i;
+
+	vector<unique_ptr<Chunk>> edited;
+
+	nb_parsed_lines = count_lines(region);
+
+	if(!parse_chunks(region, region_line, a, edited)) {
+		string content;
+
+		for(size_t i = 0; i < chunks.size(); i++)
+			content += (i == a ? region : "") + chunks[i]->text;
+
+		if(a == chunks.size())
+			content += region;
+
+		return parse_all(move(content));
+	}
+
+	for(const auto& chunk : edited) {
+		dirty_shapes.insert(chunk->shapes.begin(), chunk->shapes.end());
+		dirty_colors.insert(chunk->colors.begin(), chunk->colors.end());
+	}
+
+	size_t nb_edited = edited.size();
+
+	chunks.insert(chunks.begin() + long(a), make_move_iterator(edited.begin()), make_move_iterator(edited.end()));
+
+	for(size_t i = a + nb_edited; i < chunks.size(); i++) {
+		chunks[i]->index = i;
+		chunks[i]->first_line = (unsigned long) (long(chunks[i]->first_line) + delta);
+	}
+
+	/// The following chunks that depend on the names defined by the edited chunks
+	/// (directly or not) are parsed again, in the order of the content.
+	vector<string> shape_names(dirty_shapes.begin(), dirty_shapes.end());
+	vector<string> color_names(dirty_colors.begin(), dirty_colors.end());
+	unordered_set<Chunk*> dependents;
+
+	auto add_users = [&](const unordered_set<Chunk*>& users) {
+		for(Chunk* user : users) {
+			if(user->index >= a + nb_edited && dependents.insert(user).second) {
+				shape_names.insert(shape_names.end(), user->shapes.begin(), user->shapes.end());
+				color_names.insert(color_names.end(), user->colors.begin(), user->colors.end());
+			}
+		}
+	};
+
+	while(!shape_names.empty() || !color_names.empty()) {
+		if(!shape_names.empty()) {
+			auto it = shape_users.find(shape_names.back());
+
+			shape_names.pop_back();
+
+			if(it != shape_users.end())
+				add_users(it->second);
+		} else {
+			auto it = color_users.find(color_names.back());
+
+			color_names.pop_back();
+
+			if(it != color_users.end())
+				add_users(it->second);
+		}
+	}
+
+	vector<size_t> order;
+
+	for(Chunk* chunk : dependents)
+		order.push_back(chunk->index);
+
+	sort(order.begin(), order.end());
+
+	for(size_t i : order) {
+		Chunk* chunk = chunks[i].get();
+		vector<unique_ptr<Chunk>> parsed;
+
+		forget(chunk);
+
+		nb_parsed_lines += chunk->nb_lines;
+
+		if(!parse_chunks(chunk->text, chunk->first_line, i, parsed) || parsed.size() != 1) {
+			string content;
+
+			for(const auto& c : chunks)
+				content += c->text;
+
+			return parse_all(move(content));
+		}
+
+		chunks[i] = move(parsed[0]);
+	}
+
+	return get_result();
+}
+
+/* Private methods */
+
+bool IncrementalParser::parse_chunks(const string& text, unsigned long first_line, size_t index, vector<unique_ptr<Chunk>>& out) {
+	Parser parser(filename);
+
+	parser.set_scope(this);
+	parser.lexer.open_buffer(text.data(), text.size(), first_line);
+	parser.stream.start(0);
+
+	/// The parser makes its shapes with the ones of all the chunks (whatever the size of the content).
+	parser.sharing = true;
+	parser.nodes.swap(nodes);
+
+	unique_ptr<Chunk> chunk;
+	size_t begin = 0;
+
+	auto open_chunk = [&](unsigned long line) {
+		chunk = make_unique<Chunk>();
+		chunk->first_line = line;
+		chunk->index = index + out.size();
+
+		current = chunk.get();
+		parser.made = &chunk->nodes;
+	};
+
+	/// The names defined by a chunk are moved from the parser to the names of the content.
+	auto close_chunk = [&](size_t end, unsigned long next_line) {
+		chunk->text = text.substr(begin, end - begin);
+		chunk->nb_lines = next_line - chunk->first_line;
+
+		for(const Shape* node : chunk->nodes)
+			node_uses[node]++;
+
+		nb_made += chunk->nodes.size();
+
+		for(const auto& s : parser.shapes) {
+			shapes[s.first] = {chunk.get(), s.second};
+			chunk->shapes.push_back(s.first);
+		}
+
+		for(const auto& c : parser.colors) {
+			colors[c.first] = {chunk.get(), c.second};
+			chunk->colors.push_back(c.first);
+		}
+
+		chunk->imports = move(parser.imports);
+
+		parser.shapes.clear();
+		parser.shapes_name.clear();
+		parser.colors.clear();
+		parser.colors_name.clear();
+		parser.imports.clear();
+
+		out.push_back(move(chunk));
+		begin = end;
+	};
+
+	open_chunk(first_line);
+
+	try {
+		bool has_instr = false;
+
+		if(index == 0) {
+			parser.parse_size();
+
+			width = parser.get_width();
+			height = parser.get_height();
+			has_instr = true;
+		}
+
+		unsigned long previous_line = parser.last_line;
+		token keyword = parser.next_token(1);
+
+		while(keyword.type != END) {
+			/// A new chunk begins with an instruction on a new line.
+			if(has_instr && keyword.line > previous_line) {
+				size_t end = keyword.offset;
+
+				while(end > begin && text[end - 1] != '\n')
+					end--;
+
+				close_chunk(end, keyword.line);
+				open_chunk(keyword.line);
+			}
+
+			size_t nb_fills = parser.fills.size();
+
+			parser.parse_statement(keyword);
+			has_instr = true;
+
+			if(parser.fills.size() > nb_fills)
+				chunk->fills.push_back(parser.fills.back());
+
+			previous_line = parser.last_line;
+			keyword = parser.next_token(1);
+		}
+
+		close_chunk(text.size(), keyword.line);
+	} catch(const Parser::ParseError&) {
+		current = nullptr;
+		parser.nodes.swap(nodes);
+
+		return false;
+	}
+
+	current = nullptr;
+	parser.nodes.swap(nodes);
+
+	return true;
+}
+
+void IncrementalParser::forget(Chunk* chunk) {
+	for(const string& name : chunk->shapes) {
+		auto it = shapes.find(name);
+
+		if(it != shapes.end() && it->second.chunk == chunk)
+			shapes.erase(it);
+	}
+
+	for(const string& name : chunk->colors) {
+		auto it = colors.find(name);
+
+		if(it != colors.end() && it->second.chunk == chunk)
+			colors.erase(it);
+	}
+
+	for(const string& name : chunk->used_shapes) {
+		auto it = shape_users.find(name);
+
+		if(it != shape_users.end() && it->second.erase(chunk) && it->second.empty())
+			shape_users.erase(it);
+	}
+
+	for(const string& name : chunk->used_colors) {
+		auto it = color_users.find(name);
+
+		if(it != color_users.end() && it->second.erase(chunk) && it->second.empty())
+			color_users.erase(it);
+	}
+
+	/// The shapes made by no chunk anymore can't be shared.
+	for(const Shape* node : chunk->nodes) {
+		auto it = node_uses.find(node);
+
+		if(it == node_uses.end() || --it->second > 0)
+			continue;
+
+		node_uses.erase(it);
+
+		auto range = nodes.equal_range(node->get_hash());
+
+		for(auto n = range.first; n != range.second; n++) {
+			if(n->second.get() == node) {
+				nodes.erase(n);
+				break;
+			}
+		}
+	}
+
+	nb_made -= chunk->nodes.size();
+	chunk->nodes.clear();
+}
+
+ParseResult IncrementalParser::parse_all(string content) {
+	chunks.clear();
+	shapes.clear();
+	colors.clear();
+	shape_users.clear();
+	color_users.clear();
+	nodes.clear();
+	node_uses.clear();
+	nb_made = 0;
+
+	nb_parsed_lines = count_lines(content);
+
+	if(parse_chunks(content, 1, 0, chunks)) {
+		valid = true;
+		invalid_content.clear();
+
+		return get_result();
+	}
+
+	chunks.clear();
+	shapes.clear();
+	colors.clear();
+	shape_users.clear();
+	color_users.clear();
+	nodes.clear();
+	node_uses.clear();
+	nb_made = 0;
+
+	/// The diagnostic is the one of a parser of the whole content.
+	Parser parser(filename);
+	ParseResult result = parser.parse_buffer(content);
+
+	valid = false;
+	invalid_content = move(content);
+
+	return result;
+}
+
+ParseResult IncrementalParser::get_result() const {
+	ParseResult result = {true, {width, height, {}, shapes.size(), colors.size(), nb_made - node_uses.size(), {}}, Diagnostic()};
+
+	for(const auto& chunk : chunks) {
+		for(const auto& module : chunk->imports)
+			Modules::add_files(result.scene.imports, *module);
+
+		result.scene.fills.insert(result.scene.fills.end(), chunk->fills.begin(), chunk->fills.end());
+	}
+
+	return result;
+}
+
+/* Scope */
+
+shared_ptr<Shape> IncrementalParser::find_shape(const string& name) {
+	auto it = shapes.find(name);
+
+	if(it == shapes.end() || it->second.chunk->index >= current->index)
+		return nullptr;
+
+	if(shape_users[name].insert(current).second)
+		current->used_shapes.push_back(name);
+
+	return it->second.shape;
+}
+
+bool IncrementalParser::find_color(const string& name, Color& c) {
+	auto it = colors.find(name);
+
+	if(it == colors.end() || it->second.chunk->index >= current->index)
+		return false;
+
+	if(color_users[name].insert(current).second)
+		current->used_colors.push_back(name);
+
+	c = it->second.color;
+
+	return true;
+}
+
+bool IncrementalParser::has_shape(const string& name) const {
+	return shapes.count(name) > 0;
+}
+
+bool IncrementalParser::has_color(const string& name) const {
+	return colors.count(name) > 0;
+}
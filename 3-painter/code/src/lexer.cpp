@@ -0,0 +1,569 @@
+/**
+ * Object-oriented programming project - Project 3
+ * Drawing geometric figures
+ *
+ * @author Maxime Meurisse (m.meurisse@student.uliege.be) - 20161278
+ * @version 2019.05.15
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "headers/lexer.hpp"
+#include "headers/geometry.hpp"
+#include "../../../common/paint_chars.hpp"
+
+using namespace std;
+
+/// Classes of the chars of a paint file (cfr. 'make_classes').
+static const CharClasses CHAR_CLASSES = make_classes(true);
+
+/// Powers of 10 that are exactly represented by a double.
+static const double POWERS_OF_10[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/// Largest integer such that all the integers up to it are exactly represented by a double.
+static const uint64_t MAX_EXACT = uint64_t(1) << 53;
+
+/**
+ * Convert a number of the paint language ([+-] digits [. digits]) to a double, in one pass.
+ *
+ * If the digits of the number fit in the mantissa of a double and if it has at most 22 decimals,
+ * the result is the quotient of two doubles that are exactly represented, which is correctly
+ * rounded (as the result of 'strtod'). Otherwise, 'strtod' is used.
+ *
+ * @param s the number
+ * @param length the length of the number
+ * @return the value of the number
+ */
+static double scan_number(const char* s, size_t length) {
+	const char* end = s + length;
+	const char* c = s;
+	bool negative = false, fraction = false;
+	uint64_t mantissa = 0;
+	size_t decimals = 0;
+
+	if(c != end && (*c == '+' || *c == '-'))
+		negative = (*c++ == '-');
+
+	for(; c != end; c++) {
+		if(*c == '.') {
+			fraction = true;
+
+			continue;
+		}
+
+		mantissa = mantissa * 10 + uint64_t(*c - '0');
+
+		if(fraction)
+			decimals++;
+
+		if(mantissa >= MAX_EXACT || decimals > 22)
+			break;
+	}
+
+	if(c == end) {
+		double value = double(mantissa) / POWERS_OF_10[decimals];
+
+		return negative ? -value : value;
+	}
+
+	/// Slow path (the number is copied to be null-terminated).
+	return strtod(string(s, length).c_str(), nullptr);
+}
+
+/**
+ * Return the keyword whose name is 'name'.
+ * The name is found with its length and its first char, and compared once.
+ *
+ * @param name the name (not null-terminated)
+ * @param length the length of the name
+ * @return the keyword ('NO_KEYWORD' if 'name' is not a keyword)
+ */
+static keyword to_keyword(const char* name, size_t length) {
+	keyword k = NO_KEYWORD;
+	const char* expected = nullptr;
+
+	switch(length) {
+		case 3:
+			switch(name[0]) {
+				case 't': k = KW_TRI; expected = "tri"; break;
+				case 'r': k = KW_ROT; expected = "rot"; break;
+			}
+
+			break;
+
+		case 4:
+			switch(name[0]) {
+				case 's': k = KW_SIZE; expected = "size"; break;
+				case 'c': k = KW_CIRC; expected = "circ"; break;
+				case 'e': k = KW_ELLI; expected = "elli"; break;
+				case 'r': k = KW_RECT; expected = "rect"; break;
+				case 'd': k = KW_DIFF; expected = "diff"; break;
+				case 'f': k = KW_FILL; expected = "fill"; break;
+			}
+
+			break;
+
+		case 5:
+			switch(name[0]) {
+				case 's': k = KW_SHIFT; expected = "shift"; break;
+				case 'u': k = KW_UNION; expected = "union"; break;
+				case 'c': k = KW_COLOR; expected = "color"; break;
+			}
+
+			break;
+
+		case 6:
+			if(name[0] == 'i') {
+				k = KW_IMPORT;
+				expected = "import";
+			}
+
+			break;
+	}
+
+	if(expected && memcmp(name, expected, length) == 0)
+		return k;
+
+	return NO_KEYWORD;
+}
+
+/*********/
+/* Lexer */
+/*********/
+
+Lexer::~Lexer() {
+	if(mapped)
+		munmap(const_cast<char*>(data), data_size);
+}
+
+bool Lexer::open(const string& filename) {
+	struct stat st;
+	int fd = ::open(filename.c_str(), O_RDONLY);
+
+	if(fd < 0)
+		return false;
+
+	if(fstat(fd, &st) < 0) {
+		close(fd);
+
+		return false;
+	}
+
+	data_size = size_t(st.st_size);
+
+	/// An empty file can't be mapped (but has no content anyway).
+	if(data_size > 0) {
+		void* m = mmap(nullptr, data_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+		if(m == MAP_FAILED) {
+			close(fd);
+
+			return false;
+		}
+
+		madvise(m, data_size, MADV_SEQUENTIAL);
+
+		data = static_cast<const char*>(m);
+		mapped = true;
+	}
+
+	close(fd);
+
+	return true;
+}
+
+void Lexer::open_buffer(const char* buffer, size_t size, unsigned long first_line) {
+	data = buffer;
+	data_size = size;
+	line = first_line - 1;
+}
+
+size_t Lexer::read(token* o, size_t max) {
+	out = o;
+	out_count = 0;
+
+	/// A step produces at most 3 tokens.
+	while(!finished && !error && out_count + 3 <= max)
+		step();
+
+	return out_count;
+}
+
+string Lexer::get_content(const token& t) const {
+	if(t.type == END)
+		return "END";
+
+	return string(data + t.offset, t.length);
+}
+
+double Lexer::get_number(const token& t) const {
+	return scan_number(data + t.offset, t.length);
+}
+
+void Lexer::step() {
+	/// Beginning of a line, or end of the file.
+	if(!in_line) {
+		flush();
+
+		if(error)
+			return;
+
+		if(pos < data_size) {
+			const char* eol = static_cast<const char*>(memchr(data + pos, '\n', data_size - pos));
+
+			line_end = eol ? size_t(eol - data) : data_size;
+			line++;
+			col = 0;
+			in_line = true;
+		} else {
+			token end = {++line, 0, END, 0, 0, NO_KEYWORD, NO_POINT};
+
+			out[out_count++] = end;
+			finished = true;
+		}
+
+		return;
+	}
+
+	if(pos >= line_end) {
+		pos = line_end + 1;
+		in_line = false;
+
+		return;
+	}
+
+	size_t i = pos++;
+	char c = data[i];
+	unsigned char c_class = CHAR_CLASSES[uint8_t(c)];
+
+	col++;
+
+	if(c_class == C_COMMENT) { /// comment
+		flush();
+
+		pos = line_end;
+	} else if(c_class == C_SPACE) { /// space
+		flush();
+	} else if(c_class == C_SPECIAL) { /// specials chars
+		flush();
+
+		if(error)
+			return;
+
+		begin = i;
+		length = 1;
+
+		switch(c) {
+			case '{': push_token(OPEN_BRACE); break;
+			case '}': push_token(CLOSE_BRACE); break;
+			case '(': push_token(OPEN_PAR); break;
+			case ')': push_token(CLOSE_PAR); break;
+			case '*':
+			case '/': push_token(OPERATOR); break;
+			case '"': { /// path (until the next '"' of the line)
+				const char* quote = static_cast<const char*>(memchr(data + pos, '"', line_end - pos));
+
+				if(!quote) {
+					error_token = {line, col - 1, PATH, i, line_end - i, NO_KEYWORD, NO_POINT};
+					error_message = "missing '\"' at the end of the path ('" + string(data + i, line_end - i) + "').";
+					error = true;
+
+					return;
+				}
+
+				length = size_t(quote - data) + 1 - i;
+				col += length - 1;
+				pos = i + length;
+
+				push_token(PATH);
+				break;
+			}
+		}
+	} else if(c_class == C_POINT) { /// point (".")
+		token t;
+
+		if(!create_token(t))
+			return;
+
+		if(t.type == STRING) {
+			push_token(t);
+
+			begin = i;
+			length = 1;
+			push_token(POINT);
+		} else if(t.type == NUMBER) {
+			append(i);
+		} else {
+			context |= (last_type == END);
+
+			if(last_type == CLOSE_BRACE || last_type == CLOSE_PAR) {
+				begin = i;
+				length = 1;
+				push_token(POINT);
+			} else {
+				append(i);
+			}
+		}
+	} else if((c == 'x' || c == 'y') && length > 0 && data[begin + length - 1] == '.') { /// special points
+		push_token(POINT);
+		append(i);
+		flush();
+	} else { /// names and numbers (the next chars of the run are added at once)
+		append(i);
+
+		size_t end = scan_run(CHAR_CLASSES, data, pos, line_end, classes, nb_signs);
+
+		col += end - pos;
+		length += end - pos;
+		pos = end;
+	}
+}
+
+bool Lexer::create_token(token& t) {
+	t = {line, col - length, END, begin, length, NO_KEYWORD, NO_POINT};
+
+	if(length > 0) {
+		const char* content = data + begin;
+
+		/// The type is given by the classes of the chars of the buffer (cfr. 'append').
+		if(length == 1 && nb_signs == 1) {
+			t.type = OPERATOR;
+		} else if((classes & ~(C_DIGIT | C_POINT | C_SIGN)) == 0 && (classes & C_DIGIT) && nb_points <= 1 && nb_signs <= 1) {
+			if(nb_signs == 0) {
+				t.type = NUMBER;
+			} else if(content[0] == '+' || content[0] == '-') {
+				t.type = NUMBER;
+			} else {
+				error_message = "misplaced operator ('" + string(content, length) + "').";
+				error = true;
+			}
+		} else if((classes & ~(C_NAME | C_DIGIT)) == 0 && is_letter(content[0])) {
+			t.type = STRING;
+			t.keyword = to_keyword(content, length);
+			t.point = to_named_point(content, length);
+		} else {
+			error_message = "invalid element ('" + string(content, length) + "').";
+			error = true;
+		}
+	}
+
+	if(error)
+		error_token = t;
+
+	return !error;
+}
+
+void Lexer::push_token(const token& t) {
+	out[out_count++] = t;
+	last_type = t.type;
+	length = 0;
+}
+
+void Lexer::push_token(unsigned int type) {
+	token t = {line, col - length, type, begin, length, NO_KEYWORD, NO_POINT};
+
+	push_token(t);
+}
+
+void Lexer::flush() {
+	token t;
+
+	if(length > 0 && create_token(t))
+		push_token(t);
+}
+
+void Lexer::append(size_t i) {
+	unsigned char c_class = CHAR_CLASSES[uint8_t(data[i])];
+
+	if(length == 0) {
+		begin = i;
+		classes = 0;
+		nb_signs = nb_points = 0;
+	}
+
+	length++;
+	classes |= c_class;
+	nb_signs += (c_class == C_SIGN);
+	nb_points += (c_class == C_POINT);
+}
+
+/***************/
+/* TokenStream */
+/***************/
+
+TokenStream::~TokenStream() {
+	{
+		lock_guard<std::mutex> lock(mutex);
+
+		stop = true;
+	}
+
+	not_full.notify_all();
+
+	for(thread& worker : workers)
+		worker.join();
+}
+
+void TokenStream::start(unsigned int threads) {
+	threaded = threads > 0;
+	started = true;
+
+	if(threaded) {
+		nb_parts = (lexer.data_size + PART_SIZE - 1) / PART_SIZE;
+		max_parts = max(size_t(QUEUE_SIZE), 2 * size_t(threads));
+
+		for(unsigned int i = 0; i < threads; i++)
+			workers.emplace_back(&TokenStream::produce, this);
+	}
+}
+
+bool TokenStream::fill(vector<token>& block) {
+	if(!started)
+		return false;
+
+	if(!threaded) {
+		block.resize(BLOCK_SIZE);
+		block.resize(lexer.read(block.data(), BLOCK_SIZE));
+
+		return !block.empty();
+	}
+
+	while(!finished) {
+		unique_lock<std::mutex> lock(mutex);
+
+		/// The last token of the file.
+		if(first_part == nb_parts) {
+			token end = {lexer.line + nb_lines + 1, 0, END, 0, 0, NO_KEYWORD, NO_POINT};
+
+			block.assign(1, end);
+			finished = true;
+
+			return true;
+		}
+
+		not_empty.wait(lock, [this] { return !parts.empty() && parts.front().done; });
+
+		Part part = move(parts.front());
+
+		parts.pop_front();
+		first_part++;
+
+		lock.unlock();
+		not_full.notify_all();
+
+		if(part.context && (last_type == CLOSE_BRACE || last_type == CLOSE_PAR))
+			convert(part, last_type);
+
+		for(token& t : part.tokens)
+			t.line += lexer.line + nb_lines;
+
+		if(part.error) {
+			lexer.error = true;
+			lexer.error_token = part.error_token;
+			lexer.error_token.line += lexer.line + nb_lines;
+			lexer.error_message = part.error_message;
+
+			finished = true;
+		}
+
+		if(!part.tokens.empty())
+			last_type = part.last_type;
+
+		nb_lines += part.nb_lines;
+
+		if(!part.tokens.empty()) {
+			block = move(part.tokens);
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void TokenStream::drain() {
+	vector<token> block;
+
+	while(fill(block));
+}
+
+size_t TokenStream::part_begin(size_t k) const {
+	size_t pos = k * PART_SIZE;
+
+	if(pos == 0 || pos >= lexer.data_size || lexer.data[pos - 1] == '\n')
+		return min(pos, lexer.data_size);
+
+	const char* eol = static_cast<const char*>(memchr(lexer.data + pos, '\n', lexer.data_size - pos));
+
+	return eol ? size_t(eol - lexer.data) + 1 : lexer.data_size;
+}
+
+void TokenStream::convert(Part& part, unsigned int last) const {
+	Lexer l;
+	size_t n = 0, count;
+
+	/// The lexer only sees the lines of the part.
+	l.data = lexer.data;
+	l.data_size = part.end;
+	l.pos = part.begin;
+	l.last_type = last;
+
+	do {
+		part.tokens.resize(n + BLOCK_SIZE);
+		count = l.read(part.tokens.data() + n, BLOCK_SIZE);
+		n += count;
+	} while(count > 0);
+
+	part.tokens.resize(n);
+
+	part.error = l.error;
+	part.error_token = l.error_token;
+	part.error_message = l.error_message;
+
+	/// The line of the "END" token follows the last line of the part.
+	if(!part.error) {
+		part.nb_lines = part.tokens.back().line - 1;
+		part.tokens.pop_back();
+	}
+
+	part.last_type = l.last_type;
+	part.context = l.context;
+}
+
+void TokenStream::produce() {
+	while(true) {
+		unique_lock<std::mutex> lock(mutex);
+
+		not_full.wait(lock, [this] { return stop || next_part == nb_parts || next_part < first_part + max_parts; });
+
+		if(stop || next_part == nb_parts)
+			return;
+
+		parts.emplace_back();
+
+		Part& part = parts.back();
+
+		part.begin = part_begin(next_part);
+		part.end = part_begin(++next_part);
+
+		lock.unlock();
+
+		convert(part, END);
+
+		lock.lock();
+		part.done = true;
+		not_empty.notify_one();
+	}
+}
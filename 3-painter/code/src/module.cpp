@@ -0,0 +1,125 @@
+/**
+ * Object-oriented programming project - Project 3
+ * Drawing geometric figures
+ *
+ * @author Maxime Meurisse (m.meurisse@student.uliege.be) - 20161278
+ * @version 2019.05.15
+ */
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "headers/module.hpp"
+#include "headers/compiler.hpp"
+
+using namespace std;
+
+const string Modules::COMPILED_EXT = ".paintm";
+
+map<string, shared_ptr<const Module>> Modules::loaded;
+set<string> Modules::loading;
+recursive_mutex Modules::lock;
+
+/* Public methods */
+
+shared_ptr<const Module> Modules::load(const string& filename, Diagnostic& error) {
+	/// The modules are identified by their real path (the same module can be imported with different paths).
+	char* real = realpath(filename.c_str(), nullptr);
+
+	if(!real) {
+		error = {filename, 0, 0, "unable to open module '" + filename + "'."};
+
+		return nullptr;
+	}
+
+	string path(real);
+
+	free(real);
+
+	lock_guard<recursive_mutex> guard(lock);
+
+	auto it = loaded.find(path);
+
+	if(it != loaded.end())
+		return it->second;
+
+	if(loading.count(path) > 0) {
+		error = {filename, 0, 0, "cycle of imports with module '" + filename + "'."};
+
+		return nullptr;
+	}
+
+	/// The compiled file replaces the extension of the module (if any).
+	size_t dot = path.find_last_of('.');
+
+	if(dot == string::npos || dot < path.find_last_of('/'))
+		dot = path.size();
+
+	string compiled = path.substr(0, dot) + COMPILED_EXT;
+
+	auto module = make_shared<Module>();
+
+	module->filename = path;
+
+	loading.insert(path);
+
+	bool valid = Compiler::load_module(compiled, *module);
+
+	if(!valid && (valid = parse(*module, filename, error)))
+		Compiler::save_module(compiled, *module);
+
+	loading.erase(path);
+
+	if(!valid)
+		return nullptr;
+
+	loaded[path] = module;
+
+	return module;
+}
+
+void Modules::add_files(vector<pair<string, uint64_t>>& files, const Module& module) {
+	for(const auto& f : module.files)
+		if(find(files.begin(), files.end(), f) == files.end())
+			files.push_back(f);
+}
+
+void Modules::clear() {
+	lock_guard<recursive_mutex> guard(lock);
+
+	loaded.clear();
+}
+
+/* Private methods */
+
+bool Modules::parse(Module& module, const string& filename, Diagnostic& error) {
+	uint64_t hash;
+
+	if(!Compiler::hash_file(module.filename, hash)) {
+		error = {filename, 0, 0, "unable to open module '" + filename + "'."};
+
+		return false;
+	}
+
+	Parser parser(filename);
+
+	parser.is_module = true;
+
+	ParseResult result = parser.parse_file();
+
+	if(!result.valid) {
+		error = result.error;
+
+		return false;
+	}
+
+	module.shapes = move(parser.shapes);
+	module.colors = move(parser.colors);
+	module.imports = move(parser.imports);
+	module.files = {{module.filename, hash}};
+
+	for(const auto& import : module.imports)
+		add_files(module.files, *import);
+
+	return true;
+}
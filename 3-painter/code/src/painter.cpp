@@ -19,6 +19,8 @@
 #include "headers/geometry.hpp"
 #include "headers/graphics.hpp"
 #include "headers/parser.hpp"
+#include "headers/compiler.hpp"
+#include "headers/renderer.hpp"
 
 using namespace std;
 
@@ -30,18 +32,22 @@ int main(int argc, char* argv[]) {
 
 	size_t width, height; /// dimension of the image
 	string input, filename, extension; /// data about input of the user
-	vector<shared_ptr<Shape>> fills; /// shapes to draw
+	vector<Fill> fills; /// shapes to draw, with their colors
+	bool compile = false; /// only compile the paint file (cfr. 'Compiler')
 
 	/* Input verification */
 
 	/// Number of argument (only one paint file is accepted)
-	if(argc < 2 || argc > 2) {
-		cerr << "Usage : " << argv[0] << " INPUT_FILE" << endl;
+	if(argc == 3 && string(argv[1]) == "-c")
+		compile = true;
+
+	if(argc != (compile ? 3 : 2)) {
+		cerr << "Usage : " << argv[0] << " [-c] INPUT_FILE" << endl;
 
 		return 1;
 	}
 
-	input = argv[1];
+	input = argv[compile ? 2 : 1];
 
 	/// Length of the input (at least the length of the extension)
 	if(input.length() <= VALID_EXT.length()) {
@@ -63,30 +69,63 @@ int main(int argc, char* argv[]) {
 
 	/* Parsing the input */
 
-	Parser parser(input);
+	/// The scene is loaded from the compiled file if it is up to date.
+	/// Otherwise, the paint file is parsed (and its compiled file is rebuilt).
+	string compiled = filename + ".paintc";
+	uint64_t hash = 0;
+	bool has_compiled = ifstream(compiled).good();
+	bool hashed = (compile || has_compiled) && Compiler::hash_file(input, hash);
 
-	cout << "Parsing file... " << flush;
+	Scene scene;
 
 	auto start = chrono::steady_clock::now();
 
-	parser.parse_file();
+	if(!compile && hashed && Compiler::load(compiled, hash, scene)) {
+		auto time_loader = chrono::duration <double, milli> (chrono::steady_clock::now() - start).count();
 
-	auto end = chrono::steady_clock::now();
-	auto diff = end - start;
-	auto time_parser = chrono::duration <double, milli> (diff).count();
+		cout << "Loading compiled file... DONE in " << time_loader << " ms" << endl;
+	} else {
+		Parser parser(input);
+
+		cout << "Parsing file... " << flush;
+
+		start = chrono::steady_clock::now();
+
+		ParseResult result = parser.parse_file();
+
+		if(!result.valid) {
+			cerr << result.error.str() << endl;
+
+			return 1;
+		}
+
+		auto time_parser = chrono::duration <double, milli> (chrono::steady_clock::now() - start).count();
+
+		cout << "DONE in " << time_parser << " ms" << endl;
+
+		scene = result.scene;
+
+		if(hashed && !Compiler::save(compiled, scene, hash)) {
+			cerr << "Unable to create compiled file" << endl;
+
+			return 1;
+		}
+	}
 
-	cout << "DONE in " << time_parser << " ms" << endl;
 	cout << SEPARATOR << endl;
 
-	parser.print_stats();
+	scene.print_stats();
 
 	cout << SEPARATOR << endl;
 
+	if(compile)
+		return 0;
+
 	/* Filling the image */
 
-	width = parser.get_width();
-	height = parser.get_height();
-	fills = parser.get_fills();
+	width = scene.width;
+	height = scene.height;
+	fills = scene.fills;
 
 	ofstream outfile(filename + ".ppm", ios::binary);
 
@@ -103,33 +142,14 @@ int main(int argc, char* argv[]) {
 
 	Image img(width, height);
 
-	int x_min, x_max, y_min, y_max;
-	domain dom;
-
-	/// For each shape, we check pixels that are in the domain of the shape.
-	for(auto shape = fills.rbegin(); shape != fills.rend(); shape++) {
-		dom = (*shape)->get_domain();
-
-		x_min = max(int(dom[0].x), int(0));
-		y_min = max(int(dom[0].y), int(0));
-		x_max = min(int(++dom[1].x), int(width));
-		y_max = min(int(++dom[1].y), int(height));
-
-		for(int x = x_min; x < x_max; x++) {
-			for(int y = y_min; y < y_max; y++) {
-				if(!img(size_t(x), size_t(y)).first && (*shape)->contains(Point(double(x) + 0.5, double(y) + 0.5))) {
-					img(size_t(x), size_t(y)).first = true;
-					img(size_t(x), size_t(y)).second = (*shape)->get_color();
-				}
-			}
-		}
-	}
+	/// The tiles of the image are drawn by as many threads as there are cores (cfr. 'Renderer').
+	Renderer::draw(img, fills);
 
 	outfile << img;
 	outfile.close(); 
 
-	end = chrono::steady_clock::now();
-	diff = end - start;
+	auto end = chrono::steady_clock::now();
+	auto diff = end - start;
 	auto time_painter = chrono::duration <double, milli> (diff).count();
 
 	cout << "DONE in " << time_painter << " ms" << endl;
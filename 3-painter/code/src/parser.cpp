@@ -7,210 +7,113 @@
  */
 
 #include <iostream>
-#include <fstream>
 #include <cmath>
 #include <cstdint>
-#include <cstdlib>
+#include <typeinfo>
 
 #include "headers/parser.hpp"
+#include "headers/module.hpp"
 
 using namespace std;
 
-/* Public methods */
+/* Diagnostic */
 
-[[noreturn]] Parser::Parser() {
-	cerr << "A file is required to create a parser." << endl;
+string Diagnostic::str() const {
+	if(line == 0)
+		return message;
 
-	exit(EXIT_FAILURE);
+	return source + ":" + to_string(line) + ":" + to_string(col) + ": error: " + message;
 }
 
-Parser::Parser(string fname) {
-	if(fname.empty()) {
-		cerr << "Filename is empty." << endl;
+/* Scene */
 
-		exit(EXIT_FAILURE);
-	}
+void Scene::print_stats() const {
+	cout << "Number of shapes : " << nb_shapes << endl;
+	cout << "Number of colors : " << nb_colors << endl;
+	cout << "Number of fills : " << fills.size() << endl;
+	cout << "Number of deduplicated shapes : " << nb_shared << endl;
+}
+
+/* Public methods */
 
-	filename = fname;
+ParseResult Parser::parse_file() {
+	if(filename.empty())
+		return {false, Scene(), {filename, 0, 0, "Filename is empty."}};
+
+	if(!lexer.open(filename))
+		return {false, Scene(), {filename, 0, 0, "Unable to open file."}};
+
+	return parse_content();
 }
 
-void Parser::parse_file() {
-	convert_token();
+ParseResult Parser::parse_buffer(string content) {
+	if(filename.empty())
+		filename = "<buffer>";
+
+	buffer = move(content);
+	lexer.open_buffer(buffer.data(), buffer.size());
 
-	parse_size();
-	parse_instr();
+	return parse_content();
 }
 
 void Parser::print_stats() const {
 	cout << "Number of shapes : " << shapes.size() << endl;
 	cout << "Number of colors : " << colors.size() << endl;
 	cout << "Number of fills : " << fills.size() << endl;
+	cout << "Number of deduplicated shapes : " << nb_shared << endl;
 }
 
 /* Private methods */
 
-/****************************/
-/* Token conversion methods */
-/****************************/
-
-token Parser::create_token(unsigned long line, unsigned long col, string content, ifstream& file) const {
-	unsigned long nb_char = 0, nb_digit = 0, nb_point = 0, nb_operator = 0;
-	unsigned long content_length = content.length();
-	token t = {line, col - content_length, 0, content};
-
-	if(!content.empty()) {
-		/// We look at the type of each character of the content.
-		for(char c : content)
-			if(isalpha(c) || c == '_')
-				nb_char++;
-			else if(isdigit(c))
-				nb_digit++;
-			else if(c == '.')
-				nb_point++;
-			else if(c == '+' || c == '-')
-				nb_operator++;
-
-		/// Depending of the character types, we determine the type of the token.
-		if(nb_operator == content_length && nb_operator == 1) {
-			t.type = OPERATOR;
-		} else if(nb_digit + nb_point + nb_operator == content_length && nb_point <= 1 && nb_operator <= 1 && nb_digit >= 1) {
-			if(nb_operator == 0) {
-				t.type = NUMBER;
-			} else if(nb_operator == 1 && (content.at(0) == '+' || content.at(0) == '-')) {
-				t.type = NUMBER;
-			} else {
-				file.close();
-
-				print_error(t, "misplaced operator ('" + t.content + "').");
-			}
-		} else if(nb_char + nb_digit == content_length && isalpha(content.at(0))) {
-			t.type = STRING;
-		} else {
-			file.close();
-
-			print_error(t, "invalid element ('" + t.content + "').");
-		}
-	}
-
-	return t;
-}
-
-token Parser::create_token(unsigned long line, unsigned long col, unsigned int type, string content) const {
-	token t = {line, col - content.length(), type, content};
-
-	return t;
-}
-
-void Parser::push_token(token t, string& buffer) {
-	if(!buffer.empty()) {
-		file_content.push_back(t);
-		buffer.clear();
-	}
-}
+/************************/
+/* Token access methods */
+/************************/
 
-void Parser::convert_token() {
-	unsigned int line = 0, col = 0;
-	string line_content, buffer;
-	ifstream file;
+ParseResult Parser::parse_content() {
+	try {
+		/// The parts of large files are converted by the other cores.
+		unsigned int cores = thread::hardware_concurrency();
 
-	file.open(filename);
+		stream.start(lexer.get_size() >= THREADED_SIZE && cores > 1 ? cores - 1 : 0);
 
-	if(!file) {
-		cerr << "Unable to open file." << endl;
+		sharing = sharing || lexer.get_size() < SHARED_SIZE;
 
-		exit(EXIT_FAILURE); 
-	}
+		/// A module has no size.
+		if(is_module)
+			width = height = 0;
+		else
+			parse_size();
 
-	/// We read file line by line.
-	while(getline(file, line_content)) {
-		push_token(create_token(line, col, buffer, file), buffer);
-
-		line++;
-		col = 0;
-
-		/// We read all the character on a line.
-		for(char c : line_content) {
-			col++;
-
-			if(c == '#') { /// comment
-				push_token(create_token(line, col, buffer, file), buffer);
-
-				break;
-			} else if(c == char(32)) { /// space
-				push_token(create_token(line, col, buffer, file), buffer);
-
-				continue;
-			} else if(is_in(SPECIAL_CHARS, c)) { /// specials chars
-				push_token(create_token(line, col, buffer, file), buffer);
-
-				buffer = c;
-
-				switch(c) {
-					case '{': push_token(create_token(line, col, OPEN_BRACE, buffer), buffer); break;
-					case '}': push_token(create_token(line, col, CLOSE_BRACE, buffer), buffer); break;
-					case '(': push_token(create_token(line, col, OPEN_PAR, buffer), buffer); break;
-					case ')': push_token(create_token(line, col, CLOSE_PAR, buffer), buffer); break;
-					case '*':
-					case '/': push_token(create_token(line, col, OPERATOR, buffer), buffer); break;
-				}
-			} else if(c == '.') { /// point (".")
-				token t = create_token(line, col, buffer, file);
-
-				if(t.type == STRING) {
-					push_token(t, buffer);
-
-					buffer = c;
-					push_token(create_token(line, col, POINT, buffer), buffer);
-				} else if(t.type == NUMBER) {
-					buffer += c;
-				} else {
-					if(!file_content.empty()) {
-						token back = file_content.back();
-
-						if(back.type == CLOSE_BRACE || back.type == CLOSE_PAR) {
-							buffer = c;
-							push_token(create_token(line, col, POINT, buffer), buffer);
-						} else {
-							buffer += c;
-						}
-					} else {
-						buffer += c;
-					}
-				}
-			} else if(c == 'x' || c == 'y') { /// special points
-				if(buffer.back() == '.') {
-					push_token(create_token(line, col, POINT, buffer), buffer);
-
-					buffer = c;
-					push_token(create_token(line, col, buffer, file), buffer);
-				} else {
-					buffer += c;
-				}
-			} else {
-				buffer += c;
-			}
-		}
+		parse_instr();
+	} catch(const ParseError& e) {
+		return {false, Scene(), e.diagnostic};
 	}
 
-	push_token(create_token(line, col, buffer, file), buffer);
-
-	buffer = "END";
-	push_token(create_token(++line, buffer.length(), END, buffer), buffer);
+	ParseResult result = {true, {get_width(), get_height(), fills, shapes.size(), colors.size(), nb_shared, {}}, Diagnostic()};
 
-	file_content_size = file_content.size();
+	for(const auto& module : imports)
+		Modules::add_files(result.scene.imports, *module);
 
-	file.close();
+	return result;
 }
 
 token Parser::next_token(const unsigned long& incr = 1) {
-	if(file_content_pos >= file_content_size) {
-		cerr << "Out of file." << endl;
+	if(block_pos >= block.size()) {
+		if(!stream.fill(block)) {
+			if(lexer.failed())
+				raise_lexer_error();
 
-		exit(EXIT_FAILURE);
+			throw ParseError({filename, 0, 0, "Out of file."});
+		}
+
+		block_pos = 0;
 	}
 
-	token t = file_content.at(file_content_pos);
-	file_content_pos += incr;
+	token t = block[block_pos];
+	block_pos += incr;
+
+	if(incr > 0)
+		last_line = t.line;
 
 	actual_line = t.line;
 	actual_col = t.col;
@@ -218,6 +121,10 @@ token Parser::next_token(const unsigned long& incr = 1) {
 	return t;
 }
 
+string Parser::get_content(const token& t) const {
+	return lexer.get_content(t);
+}
+
 /*******************/
 /* Parsing methods */
 /*******************/
@@ -226,185 +133,149 @@ void Parser::parse_instr() {
 	token keyword = next_token();
 
 	while(keyword.type != END) {
-		string content = keyword.content;
-
-		if(keyword.type != STRING)
-			print_error(keyword, "invalid keyword format ('" + keyword.content + "').");
-
-		if(content == "circ")
-			parse_circ();
-		else if(content == "elli")
-			parse_elli();
-		else if(content == "rect")
-			parse_rect();
-		else if(content == "tri")
-			parse_tri();
-		else if(content == "shift")
-			parse_shift();
-		else if(content == "rot")
-			parse_rot();
-		else if(content == "union")
-			parse_union();
-		else if(content == "diff")
-			parse_diff();
-		else if(content == "color")
-			parse_color();
-		else if(content == "fill")
-			parse_fill();
-		else
-			print_error(keyword, "unknown keyword ('" + content + "').");
+		parse_statement(keyword);
 
 		keyword = next_token();
 	}
 }
 
+void Parser::parse_statement(const token& keyword) {
+	if(keyword.type != STRING)
+		raise_error(keyword, "invalid keyword format ('" + get_content(keyword) + "').");
+
+	switch(keyword.keyword) {
+		case KW_CIRC: parse_circ(); break;
+		case KW_ELLI: parse_elli(); break;
+		case KW_RECT: parse_rect(); break;
+		case KW_TRI: parse_tri(); break;
+		case KW_SHIFT: parse_shift(); break;
+		case KW_ROT: parse_rot(); break;
+		case KW_UNION: parse_union(); break;
+		case KW_DIFF: parse_diff(); break;
+		case KW_COLOR: parse_color(); break;
+		case KW_FILL: parse_fill(); break;
+		case KW_IMPORT: parse_import(); break;
+		default: raise_error(keyword, "unknown keyword ('" + get_content(keyword) + "').");
+	}
+}
+
 void Parser::parse_size() {
 	token keyword = next_token();
 
-	if(keyword.content != "size")
-		print_error(keyword, "expected 'size' keyword (got '" + keyword.content + "').");
+	if(keyword.keyword != KW_SIZE)
+		raise_error(keyword, "expected 'size' keyword (got '" + get_content(keyword) + "').");
 
 	double intpart;
 
 	width = parse_number();
 
 	if(width < 0.0 || modf(width, &intpart) != 0.0)
-		print_error("width of the image must be positive integers.");
+		raise_error("width of the image must be positive integers.");
 
 	height = parse_number();
 
 	if(height < 0.0 || modf(height, &intpart) != 0.0)
-		print_error("height of the image must be positive integers.");
+		raise_error("height of the image must be positive integers.");
 }
 
 void Parser::parse_circ() {
 	string name = parse_name();
 
-	auto it = shapes.find(name);
-
-	if(it != shapes.end())
-		print_error("shape name '" + name + "' already defined at " + to_string(shapes_name[name].first) + ":" + to_string(shapes_name[name].second) + ".");
-
-	shapes_name[name] = make_pair(actual_line, actual_col);
+	define_shape(name);
 
 	Point center = parse_point();
 	double radius = parse_number();
 
 	if(radius <= 0.0)
-		print_error("radius of circle must be positive.");
+		raise_error("radius of circle must be positive.");
 
-	shapes[name] = make_shared<Circ>(Circ(center, radius));
+	shapes[name] = make_shape(Circ(center, radius));
 }
 
 void Parser::parse_elli() {
 	string name = parse_name();
 
-	auto it = shapes.find(name);
-
-	if(it != shapes.end())
-		print_error("shape name '" + name + "' already defined at " + to_string(shapes_name[name].first) + ":" + to_string(shapes_name[name].second) + ".");
-
-	shapes_name[name] = make_pair(actual_line, actual_col);
+	define_shape(name);
 
 	Point center = parse_point();
 	double a = parse_number();
 
 	if(a <= 0.0)
-		print_error("semi-major radius of ellipse must be positive.");
+		raise_error("semi-major radius of ellipse must be positive.");
 
 	double b = parse_number();
 
 	if(b <= 0.0)
-		print_error("semi-minor radius of ellipse must be positive.");
+		raise_error("semi-minor radius of ellipse must be positive.");
 
 	if(a < b)
-		print_error("Semi-minor radius must be lesser than semi-major radius.");
+		raise_error("Semi-minor radius must be lesser than semi-major radius.");
 
-	shapes[name] = make_shared<Elli>(Elli(center, a, b));
+	shapes[name] = make_shape(Elli(center, a, b));
 }
 
 void Parser::parse_rect() {
 	string name = parse_name();
 
-	auto it = shapes.find(name);
-
-	if(it != shapes.end())
-		print_error("shape name '" + name + "' already defined at " + to_string(shapes_name[name].first) + ":" + to_string(shapes_name[name].second) + ".");
-
-	shapes_name[name] = make_pair(actual_line, actual_col);
+	define_shape(name);
 
 	Point center = parse_point();
 	double w = parse_number();
 
 	if(w <= 0.0)
-		print_error("width of rectangle must be positive.");
+		raise_error("width of rectangle must be positive.");
 
 	double h = parse_number();
 
 	if(h <= 0.0)
-		print_error("height of rectangle must be positive.");
+		raise_error("height of rectangle must be positive.");
 
-	shapes[name] = make_shared<Rect>(Rect(center, w, h));
+	shapes[name] = make_shape(Rect(center, w, h));
 }
 
 void Parser::parse_tri() {
 	string name = parse_name();
 
-	auto it = shapes.find(name);
-
-	if(it != shapes.end())
-		print_error("shape name '" + name + "' already defined at " + to_string(shapes_name[name].first) + ":" + to_string(shapes_name[name].second) + ".");
-
-	shapes_name[name] = make_pair(actual_line, actual_col);
+	define_shape(name);
 
 	Point v0 = parse_point();
 	Point v1 = parse_point();
 	Point v2 = parse_point();
 
-	shapes[name] = make_shared<Tri>(Tri(v0, v1, v2));
+	shapes[name] = make_shape(Tri(v0, v1, v2));
 }
 
 void Parser::parse_shift() {
 	string name = parse_name();
 
-	auto it = shapes.find(name);
-
-	if(it != shapes.end())
-		print_error("shape name '" + name + "' already defined at " + to_string(shapes_name[name].first) + ":" + to_string(shapes_name[name].second) + ".");
-
-	shapes_name[name] = make_pair(actual_line, actual_col);
+	define_shape(name);
 
 	Point t = parse_point();
 	string shift = parse_name();
 
-	it = shapes.find(shift);
+	shared_ptr<Shape> ref = find_shape(shift);
 
-	if(it == shapes.end())
-		print_error("shape '" + shift + "' doesn't exist.");
+	if(!ref)
+		raise_error("shape '" + shift + "' doesn't exist.");
 
-	shapes[name] = make_shared<Shift>(Shift(t, it->second));
+	shapes[name] = make_shape(Shift(t, ref));
 }
 
 void Parser::parse_rot() {
 	string name = parse_name();
 
-	auto it = shapes.find(name);
-
-	if(it != shapes.end())
-		print_error("shape name '" + name + "' already defined at " + to_string(shapes_name[name].first) + ":" + to_string(shapes_name[name].second) + ".");
-
-	shapes_name[name] = make_pair(actual_line, actual_col);
+	define_shape(name);
 
 	double angle = parse_number();
 	Point r = parse_point();
 	string rot = parse_name();
 
-	it = shapes.find(rot);
+	shared_ptr<Shape> ref = find_shape(rot);
 
-	if(it == shapes.end())
-		print_error("shape '" + rot + "' doesn't exist.");
+	if(!ref)
+		raise_error("shape '" + rot + "' doesn't exist.");
 
-	shapes[name] = make_shared<Rot>(Rot(angle, r, it->second));
+	shapes[name] = make_shape(Rot(angle, r, ref));
 }
 
 void Parser::parse_union() {
@@ -413,62 +284,52 @@ void Parser::parse_union() {
 
 	string name = parse_name();
 
-	auto it = shapes.find(name);
-
-	if(it != shapes.end())
-		print_error("shape name '" + name + "' already defined at " + to_string(shapes_name[name].first) + ":" + to_string(shapes_name[name].second) + ".");
-
-	shapes_name[name] = make_pair(actual_line, actual_col);
+	define_shape(name);
 
 	token t = next_token();
 
 	if(t.type != OPEN_BRACE)
-		print_error(t, "expected '{' (got '" + t.content + "').");
+		raise_error(t, "expected '{' (got '" + get_content(t) + "').");
 
 	do {
 		shape_name = parse_name();
 
-		it = shapes.find(shape_name);
+		shared_ptr<Shape> ref = find_shape(shape_name);
 
-		if(it == shapes.end())
-			print_error("shape '" + shape_name + "' doesn't exist.");
+		if(!ref)
+			raise_error("shape '" + shape_name + "' doesn't exist.");
 
-		union_shapes.push_back(it->second);
+		union_shapes.push_back(ref);
 	} while(next_token(0).type == STRING);
 
 	t = next_token();
 
 	if(t.type != CLOSE_BRACE)
-		print_error(t, "expected '}' (got '" + t.content + "')");
+		raise_error(t, "expected '}' (got '" + get_content(t) + "')");
 
-	shapes[name] = make_shared<Union>(Union(union_shapes));
+	shapes[name] = make_shape(Union(union_shapes));
 }
 
 void Parser::parse_diff() {
 	string name = parse_name();
 
-	auto it = shapes.find(name);
-
-	if(it != shapes.end())
-		print_error("shape name '" + name + "' already defined at " + to_string(shapes_name[name].first) + ":" + to_string(shapes_name[name].second) + ".");
-
-	shapes_name[name] = make_pair(actual_line, actual_col);
+	define_shape(name);
 
 	string shape_in = parse_name();
 
-	auto it_in = shapes.find(shape_in);
+	shared_ptr<Shape> ref_in = find_shape(shape_in);
 
-	if(it_in == shapes.end())
-		print_error("shape '" + shape_in + "' doesn't exist.");
+	if(!ref_in)
+		raise_error("shape '" + shape_in + "' doesn't exist.");
 
 	string shape_out = parse_name();
 
-	auto it_out = shapes.find(shape_out);
+	shared_ptr<Shape> ref_out = find_shape(shape_out);
 
-	if(it_out == shapes.end())
-		print_error("shape '" + shape_out + "' doesn't exist.");
+	if(!ref_out)
+		raise_error("shape '" + shape_out + "' doesn't exist.");
 
-	shapes[name] = make_shared<Diff>(Diff(it_in->second, it_out->second));
+	shapes[name] = make_shape(Diff(ref_in, ref_out));
 }
 
 Color Parser::parse_color_def() {
@@ -486,17 +347,17 @@ Color Parser::parse_color_def() {
 			r = parse_number();
 
 			if(r < 0.0 || r > 1.0)
-				print_error("red value must be between 0.0 and 1.0.");
+				raise_error("red value must be between 0.0 and 1.0.");
 
 			g = parse_number();
 
 			if(g < 0.0 || g > 1.0)
-				print_error("green value must be between 0.0 and 1.0.");
+				raise_error("green value must be between 0.0 and 1.0.");
 
 			b = parse_number();
 
 			if(b < 0.0 || b > 1.0)
-				print_error("blue value must be between 0.0 and 1.0.");
+				raise_error("blue value must be between 0.0 and 1.0.");
 
 			red = uint8_t(round(r * 255));
 			green = uint8_t(round(g * 255));
@@ -507,24 +368,20 @@ Color Parser::parse_color_def() {
 			t = next_token();
 
 			if(t.type != CLOSE_BRACE)
-				print_error(t, "expected '}' (got '" + t.content + "').");
+				raise_error(t, "expected '}' (got '" + get_content(t) + "').");
 
 			break;
 
 		case STRING: {
 			name = parse_name();
 
-			auto it = colors.find(name);
-
-			if(it == colors.end())
-				print_error("color name '" + name + "' doesn't exist.");
-
-			c = it->second;
+			if(!find_color(name, c))
+				raise_error("color name '" + name + "' doesn't exist.");
 
 			break;
 		}
 
-		default: print_error(t, "expected '{' or a color name (got '" + t.content + "').");
+		default: raise_error(t, "expected '{' or a color name (got '" + get_content(t) + "').");
 	}
 
 	return c;
@@ -533,12 +390,7 @@ Color Parser::parse_color_def() {
 void Parser::parse_color() {
 	string name = parse_name();
 
-	auto it = colors.find(name);
-
-	if(it != colors.end())
-		print_error("color name '" + name + "' already defined at " + to_string(colors_name[name].first) + ":" + to_string(colors_name[name].second) + ".");
-
-	colors_name[name] = make_pair(actual_line, actual_col);
+	define_color(name);
 
 	Color c = parse_color_def();
 
@@ -548,24 +400,194 @@ void Parser::parse_color() {
 void Parser::parse_fill() {
 	string name = parse_name();
 
-	auto it = shapes.find(name);
+	shared_ptr<Shape> shape = find_shape(name);
 
-	if(it == shapes.end())
-		print_error("shape name '" + name + "' doesn't exist.");
+	if(!shape)
+		raise_error("shape name '" + name + "' doesn't exist.");
 
 	Color c = parse_color_def();
 
-	it->second->set_color(c);
-	fills.push_back(it->second);
+	fills.emplace_back(shape, c);
+}
+
+void Parser::parse_import() {
+	token t = next_token();
+
+	if(t.type != PATH)
+		raise_error(t, "expected a path between '\"' (got '" + get_content(t) + "').");
+
+	string path = get_content(t);
+
+	path = path.substr(1, path.size() - 2);
+
+	/// A relative path is relative to the directory of the content.
+	size_t slash = filename.find_last_of('/');
+
+	if(!path.empty() && path[0] != '/' && slash != string::npos)
+		path = filename.substr(0, slash + 1) + path;
+
+	Diagnostic error;
+	shared_ptr<const Module> module = Modules::load(path, error);
+
+	if(!module) {
+		if(error.line == 0)
+			raise_error(t, error.message);
+
+		throw ParseError(error);
+	}
+
+	/// The names are defined at the position of the path (a name imported twice is defined once).
+	/// As the names of the module and the ones of the content are sorted, they are merged in one pass
+	/// ('define_shape' and 'define_color' report the names already defined otherwise).
+	auto shape = shapes.begin();
+	auto shape_pos = shapes_name.begin();
+
+	for(const auto& s : module->shapes) {
+		while(shape != shapes.end() && shape->first < s.first)
+			shape++;
+
+		while(shape_pos != shapes_name.end() && shape_pos->first < s.first)
+			shape_pos++;
+
+		if(shape != shapes.end() && shape->first == s.first) {
+			if(shape->second != s.second)
+				define_shape(s.first);
+
+			continue;
+		}
+
+		if(scope && scope->has_shape(s.first)) {
+			if(scope->find_shape(s.first) != s.second)
+				define_shape(s.first);
+
+			continue;
+		}
+
+		shapes.emplace_hint(shape, s.first, s.second);
+		shapes_name.emplace_hint(shape_pos, s.first, make_pair(actual_line, actual_col));
+	}
+
+	auto color = colors.begin();
+	auto color_pos = colors_name.begin();
+
+	auto same = [](Color a, Color b) {
+		return a.red == b.red && a.green == b.green && a.blue == b.blue;
+	};
+
+	for(const auto& c : module->colors) {
+		Color defined;
+
+		while(color != colors.end() && color->first < c.first)
+			color++;
+
+		while(color_pos != colors_name.end() && color_pos->first < c.first)
+			color_pos++;
+
+		if(color != colors.end() && color->first == c.first) {
+			if(!same(color->second, c.second))
+				define_color(c.first);
+
+			continue;
+		}
+
+		if(scope && scope->has_color(c.first)) {
+			if(!scope->find_color(c.first, defined) || !same(defined, c.second))
+				define_color(c.first);
+
+			continue;
+		}
+
+		colors.emplace_hint(color, c.first, c.second);
+		colors_name.emplace_hint(color_pos, c.first, make_pair(actual_line, actual_col));
+	}
+
+	imports.push_back(module);
+}
+
+template<typename T>
+shared_ptr<Shape> Parser::make_shape(const T& shape) {
+	if(!sharing)
+		return make_shared<T>(shape);
+
+	size_t hash = shape.get_hash();
+	auto range = nodes.equal_range(hash);
+
+	/// The shapes with the same hash are compared with their structure.
+	for(auto it = range.first; it != range.second; it++) {
+		const Shape& node = *it->second;
+
+		if(typeid(node) == typeid(T) && static_cast<const T&>(node).same(shape)) {
+			nb_shared++;
+
+			if(made)
+				made->push_back(it->second.get());
+
+			return it->second;
+		}
+	}
+
+	shared_ptr<Shape> node = make_shared<T>(shape);
+
+	nodes.emplace(hash, node);
+
+	if(made)
+		made->push_back(node.get());
+
+	return node;
+}
+
+void Parser::define_shape(const string& name) {
+	auto it = shapes_name.find(name);
+
+	if(it != shapes_name.end())
+		raise_error("shape name '" + name + "' already defined at " + to_string(it->second.first) + ":" + to_string(it->second.second) + ".");
+
+	if(scope && scope->has_shape(name))
+		raise_error("shape name '" + name + "' already defined.");
+
+	shapes_name[name] = make_pair(actual_line, actual_col);
+}
+
+void Parser::define_color(const string& name) {
+	auto it = colors_name.find(name);
+
+	if(it != colors_name.end())
+		raise_error("color name '" + name + "' already defined at " + to_string(it->second.first) + ":" + to_string(it->second.second) + ".");
+
+	if(scope && scope->has_color(name))
+		raise_error("color name '" + name + "' already defined.");
+
+	colors_name[name] = make_pair(actual_line, actual_col);
+}
+
+shared_ptr<Shape> Parser::find_shape(const string& name) {
+	auto it = shapes.find(name);
+
+	if(it != shapes.end())
+		return it->second;
+
+	return scope ? scope->find_shape(name) : nullptr;
+}
+
+bool Parser::find_color(const string& name, Color& c) {
+	auto it = colors.find(name);
+
+	if(it != colors.end()) {
+		c = it->second;
+
+		return true;
+	}
+
+	return scope && scope->find_color(name, c);
 }
 
 string Parser::parse_name() {
 	token name = next_token();
 
 	if(name.type != STRING)
-		print_error(name, "expected string type for name (got '" + name.content + "').");
+		raise_error(name, "expected string type for name (got '" + get_content(name) + "').");
 
-	return name.content;
+	return get_content(name);
 }
 
 double Parser::parse_number() {
@@ -577,21 +599,21 @@ double Parser::parse_number() {
 		t = next_token();
 
 		if(t.type != POINT)
-			print_error(t, "expected '.' (got '" + t.content + "').");
+			raise_error(t, "expected '.' (got '" + get_content(t) + "').");
 
 		t = next_token();
 
-		if(!(t.content.at(0) == 'x' || t.content.at(0) == 'y'))
-			print_error(t, "'" + t.content + "' is not a valid coordinate.");
+		if(!(get_content(t).at(0) == 'x' || get_content(t).at(0) == 'y'))
+			raise_error(t, "'" + get_content(t) + "' is not a valid coordinate.");
 
-		if(t.content == "x")
+		if(get_content(t) == "x")
 			return p.x;
 		else
 			return p.y;
 	} else {
 		t = next_token();
 
-		return ::atof(t.content.c_str());
+		return lexer.get_number(t);
 	}
 }
 
@@ -614,32 +636,32 @@ Point Parser::parse_point() {
 			t = next_token();
 
 			if(t.type != CLOSE_BRACE)
-				print_error(t, "expected '}' (got '" + t.content + "').");
+				raise_error(t, "expected '}' (got '" + get_content(t) + "').");
 
 			break;
 
 		case STRING: {
 			name = parse_name();
 
-			auto it = shapes.find(name);
+			shared_ptr<Shape> shape = find_shape(name);
 
-			if(it == shapes.end())
-				print_error("shape name '" + name + "' doesn't exist.");
+			if(!shape)
+				raise_error("shape name '" + name + "' doesn't exist.");
 
 			t = next_token();
 
 			if(t.type != POINT)
-				print_error(t, "expected '.' (got '" + t.content + "').");
+				raise_error(t, "expected '.' (got '" + get_content(t) + "').");
 
 			t = next_token();
 
 			if(t.type != STRING)
-				print_error(t, "expected a point name (got '" + t.content + "').");
+				raise_error(t, "expected a point name (got '" + get_content(t) + "').");
 
 			try {
-				p = it->second->get_named_point(t.content);
+				p = shape->get_named_point(NamedPoint(t.point));
 			} catch(const invalid_argument& e) {
-				print_error(t, "point " + t.content + "doesn't exist.");
+				raise_error(t, "point " + get_content(t) + "doesn't exist.");
 			}
 
 			break;
@@ -650,11 +672,11 @@ Point Parser::parse_point() {
 			t = next_token();
 
 			if(t.type != OPERATOR)
-				print_error(t, "expected an operator (+, -, * or /).");
+				raise_error(t, "expected an operator (+, -, * or /).");
 
 			p = parse_point();
 
-			switch(t.content.at(0)) {
+			switch(get_content(t).at(0)) {
 				case '+':
 					t = next_token(0);
 
@@ -683,23 +705,23 @@ Point Parser::parse_point() {
 					n = parse_number();
 
 					if(n == 0.0)
-						print_error(t, "division by 0 not allowed.");
+						raise_error(t, "division by 0 not allowed.");
 
 					p /= n;
 
 					break;
 
-				default: print_error(t, "unknown operator.");
+				default: raise_error(t, "unknown operator.");
 			}
 
 			t = next_token();
 
 			if(t.type != CLOSE_PAR)
-				print_error(t, "expected ')' (got '" + t.content + "').");
+				raise_error(t, "expected ')' (got '" + get_content(t) + "').");
 
 			break;
 
-		default: print_error(t, "expected a valid point definition.");
+		default: raise_error(t, "expected a valid point definition.");
 	}
 
 	return p;
@@ -709,26 +731,26 @@ Point Parser::parse_point() {
 /* Error management method */
 /***************************/
 
-[[noreturn]] void Parser::print_error(const token& t, const string& msg) const {
-	cerr << filename << ":" << t.line << ":" << t.col << ": error: " << msg << endl;
+[[noreturn]] void Parser::raise_error(const token& t, const string& msg) {
+	stream.drain();
 
-	exit(EXIT_FAILURE);
+	if(lexer.failed())
+		raise_lexer_error();
+
+	throw ParseError({filename, t.line, t.col, msg});
 }
 
-[[noreturn]] void Parser::print_error(const string& msg) const {
-	cerr << filename << ":" << actual_line << ":" << actual_col << ": error: " << msg << endl;
+[[noreturn]] void Parser::raise_error(const string& msg) {
+	stream.drain();
 
-	exit(EXIT_FAILURE);
-}
+	if(lexer.failed())
+		raise_lexer_error();
 
-/*******************/
-/* Utility methods */
-/*******************/
+	throw ParseError({filename, actual_line, actual_col, msg});
+}
 
-bool Parser::is_in(const array<char, 6>& a, const char& c) const {
-	for(const char& a_c : a)
-		if(a_c == c)
-			return true;
+[[noreturn]] void Parser::raise_lexer_error() const {
+	const token& t = lexer.get_error_token();
 
-	return false;
+	throw ParseError({filename, t.line, t.col, lexer.get_error_message()});
 }
@@ -0,0 +1,147 @@
+/**
+ * Object-oriented programming project - Project 3
+ * Drawing geometric figures
+ *
+ * @author Maxime Meurisse (m.meurisse@student.uliege.be) - 20161278
+ * @version 2019.05.15
+ */
+
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <iterator>
+#include <functional>
+
+#include "headers/renderer.hpp"
+
+using namespace std;
+
+/* Public methods */
+
+void Renderer::draw(Image& img, const vector<Fill>& fills, unsigned int threads) {
+	int width = int(img.get_width()), height = int(img.get_height());
+
+	size_t nb_cols = (size_t(width) + TILE_SIZE - 1) / TILE_SIZE;
+	size_t nb_rows = (size_t(height) + TILE_SIZE - 1) / TILE_SIZE;
+
+	/// Each fill is listed by the band of its first row of tiles, from the last fill to the first one.
+	vector<Area> areas(fills.size());
+	vector<vector<uint32_t>> starts(nb_rows);
+
+	for(size_t i = fills.size(); i-- > 0;) {
+		domain dom = fills[i].first->get_domain();
+
+		int x_min = max(int(dom[0].x), int(0));
+		int y_min = max(int(dom[0].y), int(0));
+		int x_max = min(int(++dom[1].x), width);
+		int y_max = min(int(++dom[1].y), height);
+
+		if(x_min >= x_max || y_min >= y_max)
+			continue;
+
+		areas[i] = {size_t(x_min), size_t(x_max), size_t(y_min), size_t(y_max)};
+		starts[areas[i].y_min / TILE_SIZE].push_back(uint32_t(i));
+	}
+
+	if(threads == 0)
+		threads = max(thread::hardware_concurrency(), 1u);
+
+	size_t nb_tiles = nb_cols * nb_rows;
+
+	threads = unsigned(min(size_t(threads), nb_tiles));
+
+	/// The fills of each band are listed when its first tile is drawn (in order, from the fills
+	/// of the last band listed), and freed when its last tile is drawn.
+	vector<Band> bands(nb_rows);
+	vector<uint32_t> band, next_band;
+	atomic<size_t> nb_listed(0);
+	mutex listing;
+
+	auto list_band = [&](size_t row) {
+		size_t y = row * TILE_SIZE;
+
+		/// The fills of the previous band still intersecting this band, and the fills starting in it.
+		next_band.clear();
+
+		for(uint32_t i : band)
+			if(areas[i].y_max > y)
+				next_band.push_back(i);
+
+		band.clear();
+		merge(next_band.begin(), next_band.end(), starts[row].begin(), starts[row].end(), back_inserter(band), greater<uint32_t>());
+		vector<uint32_t>().swap(starts[row]);
+
+		bands[row].fills = band;
+		bands[row].nb_left = nb_cols;
+	};
+
+	/// The tiles of all the bands are given to the threads one at a time, in order.
+	atomic<size_t> next_tile(0);
+
+	auto work = [&]() {
+		for(size_t t = next_tile++; t < nb_tiles; t = next_tile++) {
+			size_t row = t / nb_cols, col = t % nb_cols;
+
+			if(nb_listed.load(memory_order_acquire) <= row) {
+				lock_guard<mutex> lock(listing);
+
+				for(size_t r = nb_listed.load(memory_order_relaxed); r <= row; r++) {
+					list_band(r);
+					nb_listed.store(r + 1, memory_order_release);
+				}
+			}
+
+			size_t x = col * TILE_SIZE, y = row * TILE_SIZE;
+			Area tile = {x, min(x + TILE_SIZE, size_t(width)), y, min(y + TILE_SIZE, size_t(height))};
+
+			draw_tile(img, fills, areas, bands[row].fills, tile);
+
+			if(--bands[row].nb_left == 0)
+				vector<uint32_t>().swap(bands[row].fills);
+		}
+	};
+
+	vector<thread> workers;
+
+	for(unsigned int i = 1; i < threads; i++)
+		workers.emplace_back(work);
+
+	work();
+
+	for(thread& worker : workers)
+		worker.join();
+}
+
+/* Private methods */
+
+void Renderer::draw_tile(Image& img, const vector<Fill>& fills, const vector<Area>& areas, const vector<uint32_t>& band, const Area& tile) {
+	size_t nb_left = (tile.x_max - tile.x_min) * (tile.y_max - tile.y_min);
+
+	for(uint32_t i : band) {
+		if(areas[i].x_max <= tile.x_min || areas[i].x_min >= tile.x_max)
+			continue;
+
+		const Shape& shape = *fills[i].first;
+		Color color = fills[i].second;
+
+		size_t x_min = max(areas[i].x_min, tile.x_min), x_max = min(areas[i].x_max, tile.x_max);
+		size_t y_min = max(areas[i].y_min, tile.y_min), y_max = min(areas[i].y_max, tile.y_max);
+
+		for(size_t y = y_min; y < y_max; y++) {
+			for(size_t x = x_min; x < x_max; x++) {
+				pair<bool, Color>& pixel = img(x, y);
+
+				if(!pixel.first && shape.contains(Point(double(x) + 0.5, double(y) + 0.5))) {
+					pixel.first = true;
+					pixel.second = color;
+					nb_left--;
+				}
+			}
+		}
+
+		/// The following fills can't set any pixel of the tile.
+		if(nb_left == 0)
+			return;
+	}
+}
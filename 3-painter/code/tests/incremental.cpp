@@ -0,0 +1,258 @@
+/**
+ * Object-oriented programming project - Project 3
+ * Drawing geometric figures
+ *
+ * Differential check of the incremental parser : random edits are applied to paint files,
+ * and the result of each edit (cfr. 'IncrementalParser::edit') must be the same as the one
+ * of a full parsing of the edited content (cfr. 'Parser::parse_buffer') : the same validity,
+ * diagnostic, statistics, fills and pixels.
+ *
+ * @author Maxime Meurisse (m.meurisse@student.uliege.be) - 20161278
+ * @version 2019.05.15
+ */
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+
+#include "../src/headers/incremental.hpp"
+#include "../src/headers/renderer.hpp"
+
+using namespace std;
+
+/// Number of edits of each file, and size (in pixels) of the part of the images compared.
+static const int NB_EDITS = 300;
+static const size_t MAX_SIZE = 200;
+
+/**
+ * Split a content in lines (each one ending with a '\n').
+ */
+static vector<string> split_lines(const string& content) {
+	vector<string> lines;
+	istringstream in(content);
+	string l;
+
+	while(getline(in, l))
+		lines.push_back(l + "\n");
+
+	return lines;
+}
+
+static string join_lines(const vector<string>& lines) {
+	string content;
+
+	for(const string& l : lines)
+		content += l;
+
+	return content;
+}
+
+/**
+ * Draw (a part of) the image of a scene.
+ */
+static string draw(const Scene& scene) {
+	Image img(min(scene.width, MAX_SIZE), min(scene.height, MAX_SIZE));
+	string pixels;
+
+	Renderer::draw(img, scene.fills, 1);
+
+	for(size_t x = 0; x < img.get_width(); x++) {
+		for(size_t y = 0; y < img.get_height(); y++) {
+			pair<bool, Color> p = img(x, y);
+
+			pixels += char(p.first);
+			pixels += char(p.second.red);
+			pixels += char(p.second.green);
+			pixels += char(p.second.blue);
+		}
+	}
+
+	return pixels;
+}
+
+/**
+ * Return a boolean value indicating if two results of parsing are the same.
+ */
+static bool same_result(const ParseResult& a, const ParseResult& b) {
+	if(a.valid != b.valid)
+		return false;
+
+	if(!a.valid)
+		return a.error.str() == b.error.str();
+
+	const Scene& s = a.scene;
+	const Scene& t = b.scene;
+
+	if(s.width != t.width || s.height != t.height || s.nb_shapes != t.nb_shapes || s.nb_colors != t.nb_colors || s.nb_shared != t.nb_shared)
+		return false;
+
+	if(s.fills.size() != t.fills.size())
+		return false;
+
+	for(size_t i = 0; i < s.fills.size(); i++) {
+		Color c = s.fills[i].second, d = t.fills[i].second;
+
+		if(c.red != d.red || c.green != d.green || c.blue != d.blue)
+			return false;
+	}
+
+	return draw(s) == draw(t);
+}
+
+/**
+ * Choose a random edit of the lines of a content (the lines are replaced by the edited lines).
+ *
+ * @param lines the lines of the content
+ * @param rng the random generator
+ * @param first the first line replaced (from 1)
+ * @param nb the number of lines replaced
+ * @param text the new lines
+ */
+static void random_edit(vector<string>& lines, mt19937& rng, unsigned long& first, unsigned long& nb, string& text) {
+	static unsigned int uid = 0;
+
+	size_t size = lines.size();
+	unsigned int op = (size == 0) ? 2 : rng() % 8;
+
+	first = (size == 0) ? 1 : rng() % size + 1;
+	nb = 0;
+	text.clear();
+
+	switch(op) {
+		case 0: /// remove a line
+			nb = 1;
+			break;
+
+		case 1: /// replace a line by another one of the content
+			nb = 1;
+			text = lines[rng() % size];
+			break;
+
+		case 2: /// insert a line of the content (or a comment)
+			text = (size == 0) ? "# empty\n" : lines[rng() % size];
+			break;
+
+		case 3: /// rewrite a line without changing it
+			nb = 1;
+			text = lines[first - 1];
+			break;
+
+		case 4: /// change a digit of a line
+			nb = 1;
+			text = lines[first - 1];
+
+			if(text.find_first_of("0123456789") != string::npos)
+				text[text.find_first_of("0123456789")] = char('0' + rng() % 10);
+
+			break;
+
+		case 5: /// define a new shape (after the size)
+			first = max(first, 2ul);
+			text = "circ new" + to_string(uid++) + " {3 4} 2\n";
+			break;
+
+		case 6: /// remove a fill
+			if(lines[first - 1].compare(0, 4, "fill") == 0)
+				nb = 1;
+
+			break;
+
+		default: /// fill a new shape at the end
+			first = size + 1;
+			text = (uid > 0) ? "fill new" + to_string(rng() % uid) + " {0.5 0.2 1}\n" : "# end\n";
+			break;
+	}
+
+	if(first > size + 1)
+		first = size + 1;
+
+	if(first + nb - 1 > size)
+		nb = 0;
+
+	vector<string> edited(lines.begin(), lines.begin() + long(first - 1));
+	vector<string> added = split_lines(text);
+
+	edited.insert(edited.end(), added.begin(), added.end());
+	edited.insert(edited.end(), lines.begin() + long(first - 1 + nb), lines.end());
+
+	lines.swap(edited);
+}
+
+int main(int argc, char* argv[]) {
+	if(argc < 2) {
+		cerr << "Usage : " << argv[0] << " file.paint..." << endl;
+
+		return 1;
+	}
+
+	mt19937 rng(42);
+	size_t nb_edits = 0, nb_valid = 0, nb_mismatches = 0;
+
+	for(int f = 1; f < argc; f++) {
+		ifstream file(argv[f]);
+		stringstream content;
+
+		if(!file) {
+			cerr << "Unable to open '" << argv[f] << "'." << endl;
+
+			return 1;
+		}
+
+		content << file.rdbuf();
+
+		vector<string> lines = split_lines(content.str());
+		IncrementalParser incremental(argv[f]);
+
+		incremental.parse(join_lines(lines));
+
+		vector<string> valid_lines = lines;
+		bool valid = true;
+
+		for(int e = 0; e < NB_EDITS; e++) {
+			unsigned long first, nb;
+			string text;
+
+			/// The content often goes back to its last valid version (by replacing the lines that differ).
+			if(!valid && rng() % 2 == 0) {
+				size_t begin = 0, end = 0;
+
+				while(begin < lines.size() && begin < valid_lines.size() && lines[begin] == valid_lines[begin])
+					begin++;
+
+				while(end < lines.size() - begin && end < valid_lines.size() - begin && lines[lines.size() - 1 - end] == valid_lines[valid_lines.size() - 1 - end])
+					end++;
+
+				first = begin + 1;
+				nb = lines.size() - begin - end;
+				text = join_lines(vector<string>(valid_lines.begin() + long(begin), valid_lines.end() - long(end)));
+
+				lines = valid_lines;
+			} else {
+				random_edit(lines, rng, first, nb, text);
+			}
+
+			ParseResult edited = incremental.edit(first, nb, text);
+			ParseResult full = Parser(argv[f]).parse_buffer(join_lines(lines));
+
+			if((valid = full.valid))
+				valid_lines = lines;
+
+			nb_edits++;
+			nb_valid += full.valid;
+
+			if(!same_result(edited, full)) {
+				if(nb_mismatches++ < 5)
+					cerr << argv[f] << " : edit " << e << " (line " << first << ") differs from a full parsing." << endl;
+			}
+		}
+	}
+
+	cout << nb_edits << " edits (" << nb_valid << " valid), " << nb_mismatches << " mismatches" << endl;
+
+	return (nb_mismatches == 0) ? 0 : 1;
+}
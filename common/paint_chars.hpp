@@ -0,0 +1,151 @@
+/**
+ * Object-oriented programming projects - Projects 2 and 3
+ * Classification of the chars of a paint file
+ *
+ * This file is shared by the lexers of the parser (project 2) and of the painter (project 3).
+ *
+ * @author Maxime Meurisse (m.meurisse@student.uliege.be) - 20161278
+ * @version 2019.05.15
+ */
+
+#ifndef PAINT_CHARS_HPP
+#define PAINT_CHARS_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/// Classification of the chars (independent of the locale, only ASCII letters and digits).
+inline bool is_letter(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+
+/// Classes of the chars of a paint file (cfr. 'make_classes').
+enum char_class : unsigned char {
+	C_OTHER = 1,		/// any other char (only in invalid elements)
+	C_NAME = 2,			/// letter or '_'
+	C_DIGIT = 4,		/// 0-9
+	C_SIGN = 8,			/// + -
+	C_POINT = 16,		/// .
+	C_SPACE = 32,		/// ' '
+	C_COMMENT = 64,		/// #
+	C_SPECIAL = 128		/// { } ( ) * / (and " if the language has strings)
+};
+
+/// Classes of the chars that are added to the buffer one after the other (cfr. 'scan_run').
+static const unsigned char C_RUN = C_OTHER | C_NAME | C_DIGIT | C_SIGN;
+
+typedef std::array<unsigned char, 256> CharClasses;
+
+/**
+ * Build the class of each char.
+ *
+ * @param strings whether '"' is a special char (it is any other char otherwise)
+ * @return the classes of the 256 chars
+ */
+inline CharClasses make_classes(bool strings) {
+	CharClasses classes;
+
+	classes.fill(C_OTHER);
+
+	for(int c = 0; c < 256; c++) {
+		if(is_letter(char(c)) || c == '_')
+			classes[c] = C_NAME;
+		else if(c >= '0' && c <= '9')
+			classes[c] = C_DIGIT;
+	}
+
+	classes['+'] = classes['-'] = C_SIGN;
+	classes['.'] = C_POINT;
+	classes[' '] = C_SPACE;
+	classes['#'] = C_COMMENT;
+
+	for(char c : {'{', '}', '(', ')', '*', '/'})
+		classes[uint8_t(c)] = C_SPECIAL;
+
+	if(strings)
+		classes['"'] = C_SPECIAL;
+
+	return classes;
+}
+
+/**
+ * Find the end of a run of chars that are added to the buffer one after the other
+ * (the chars of names, numbers and invalid elements), and add their classes to the ones of the buffer.
+ * With SSE2, the chars are classified 16 at a time : the vectors stop at any char that may stop
+ * the run, and the table decides for the char they stop at (a '"' only stops the run with strings).
+ *
+ * @param char_classes the classes of the chars (cfr. 'make_classes')
+ * @param data the content
+ * @param pos the beginning of the run
+ * @param end the end of the line
+ * @param classes the classes of the chars of the buffer
+ * @param nb_signs the number of '+' and '-' of the buffer
+ * @return the end of the run
+ */
+inline size_t scan_run(const CharClasses& char_classes, const char* data, size_t pos, size_t end, unsigned char& classes, size_t& nb_signs) {
+#ifdef __SSE2__
+	/// A char is in a range if its difference with the beginning of the range, moved to the
+	/// smallest signed chars, is lower than the size of the range (moved the same way).
+	auto in_range = [](__m128i v, char first, char size) {
+		return _mm_cmplt_epi8(_mm_add_epi8(v, _mm_set1_epi8(char(0x80 - first))), _mm_set1_epi8(char(0x80 + size)));
+	};
+
+	auto equal = [](__m128i v, char c) {
+		return _mm_cmpeq_epi8(v, _mm_set1_epi8(c));
+	};
+
+	while(pos + 16 <= end) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+
+		__m128i digit = in_range(v, '0', 10);
+		__m128i name = _mm_or_si128(in_range(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 26), equal(v, '_'));
+		__m128i sign = _mm_or_si128(equal(v, '+'), equal(v, '-'));
+
+		__m128i stop = _mm_or_si128(equal(v, ' '), equal(v, '#'));
+
+		stop = _mm_or_si128(stop, _mm_or_si128(in_range(v, '(', 3), in_range(v, '.', 2)));
+		stop = _mm_or_si128(stop, _mm_or_si128(equal(v, '{'), equal(v, '}')));
+		stop = _mm_or_si128(stop, equal(v, '"'));
+
+		/// Only the chars before the first char that may stop the run are kept.
+		int stop_mask = _mm_movemask_epi8(stop);
+		int n = stop_mask ? __builtin_ctz(stop_mask) : 16;
+		int lanes = (1 << n) - 1;
+
+		int digit_mask = _mm_movemask_epi8(digit) & lanes;
+		int name_mask = _mm_movemask_epi8(name) & lanes;
+		int sign_mask = _mm_movemask_epi8(sign) & lanes;
+
+		if(digit_mask)
+			classes |= C_DIGIT;
+
+		if(name_mask)
+			classes |= C_NAME;
+
+		if(sign_mask)
+			classes |= C_SIGN;
+
+		if((digit_mask | name_mask | sign_mask) != lanes)
+			classes |= C_OTHER;
+
+		nb_signs += size_t(__builtin_popcount(unsigned(sign_mask)));
+		pos += size_t(n);
+
+		if(n < 16)
+			break;
+	}
+#endif
+
+	for(; pos < end && (char_classes[uint8_t(data[pos])] & C_RUN); pos++) {
+		classes |= char_classes[uint8_t(data[pos])];
+		nb_signs += (char_classes[uint8_t(data[pos])] == C_SIGN);
+	}
+
+	return pos;
+}
+
+#endif